@@ -0,0 +1,69 @@
+#include "adaptive.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hwmon
+{
+
+Adaptive::Clock::duration Adaptive::update(const SensorSet::key_type& sensor,
+                                           double value, Clock::time_point now,
+                                           const Bounds& bounds)
+{
+    auto it = _entries.find(sensor);
+    auto last = it == _entries.end() ? nullptr : &it->second;
+
+    // Rate of change in units per second, zero until there are two reads.
+    double rate = 0;
+    if (last && now > last->at)
+    {
+        rate = (value - last->value) /
+               std::chrono::duration<double>(now - last->at).count();
+    }
+
+    // Time until the nearest bound is reached, in seconds.
+    auto reach = std::numeric_limits<double>::infinity();
+    bool near = false;
+    auto check = [&](double bound, double headroom, double approach) {
+        if (!std::isfinite(bound))
+        {
+            return;
+        }
+        if (headroom <= _margin * std::abs(bound))
+        {
+            near = true;
+        }
+        else if (approach > 0)
+        {
+            reach = std::min(reach, headroom / approach);
+        }
+    };
+    for (auto lo : bounds.lows)
+    {
+        check(lo, value - lo, -rate);
+    }
+    for (auto hi : bounds.highs)
+    {
+        check(hi, hi - value, rate);
+    }
+
+    auto period = _min;
+    if (!near)
+    {
+        // Grow gradually, but shrink straight away when a bound nears.
+        auto grown = std::max(last ? last->period * 2 : _min, _min);
+        period = std::min(grown, _max);
+        if (std::isfinite(reach))
+        {
+            auto limit = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(reach / samples));
+            period = std::clamp(limit, _min, period);
+        }
+    }
+
+    _entries[sensor] = Entry{value, now, period};
+    return period;
+}
+
+} // namespace hwmon
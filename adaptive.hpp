@@ -0,0 +1,85 @@
+#pragma once
+
+#include "sensorset.hpp"
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+namespace hwmon
+{
+
+/** @brief The configured threshold bounds of a sensor. */
+struct Bounds
+{
+    /** @brief Bounds alarming when the value falls to them. */
+    std::vector<double> lows;
+    /** @brief Bounds alarming when the value rises to them. */
+    std::vector<double> highs;
+};
+
+/** @class Adaptive
+ *  @brief Adapts the poll period of sensors to how close they are to their
+ *         thresholds.
+ *  @details After each read the time for the value to reach the nearest
+ *  bound at its current rate of change is estimated, and the sensor is
+ *  polled often enough to be read a few times before then.  A value
+ *  within the margin of a bound, or past it, is polled at the minimum
+ *  period.  Otherwise the period doubles after each read, up to the
+ *  maximum, so stable sensors are read less and less often.
+ */
+class Adaptive
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief How many reads to fit in before a bound may be reached. */
+    static constexpr auto samples = 4;
+
+    Adaptive() = delete;
+
+    /** @brief Constructor
+     *
+     *  @param[in] min - The shortest period, the cycle interval.
+     *  @param[in] max - The longest period.
+     *  @param[in] margin - How close to a bound, as a fraction of it, to
+     *                      poll at the minimum period.
+     */
+    Adaptive(Clock::duration min, Clock::duration max, double margin) :
+        _min(min), _max(max), _margin(margin)
+    {}
+
+    /** @brief Work out the poll period of a sensor after a read.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *  @param[in] value - The value read.
+     *  @param[in] now - When it was read.
+     *  @param[in] bounds - The sensor's threshold bounds.
+     *
+     *  @return - The time until the sensor's next read.
+     */
+    Clock::duration update(const SensorSet::key_type& sensor, double value,
+                           Clock::time_point now, const Bounds& bounds);
+
+  private:
+    struct Entry
+    {
+        /** @brief The last value read. */
+        double value;
+        /** @brief When it was read. */
+        Clock::time_point at;
+        /** @brief The current period. */
+        Clock::duration period;
+    };
+
+    /** @brief The shortest period. */
+    Clock::duration _min;
+    /** @brief The longest period. */
+    Clock::duration _max;
+    /** @brief Fraction of a bound to poll at the minimum period within. */
+    double _margin;
+    /** @brief The last read of each sensor. */
+    std::map<SensorSet::key_type, Entry> _entries;
+};
+
+} // namespace hwmon
@@ -0,0 +1,69 @@
+#include "alarm_watch.hpp"
+
+#include "sysfs.hpp"
+
+#include <sys/epoll.h>
+
+#include <filesystem>
+
+namespace hwmon
+{
+
+std::vector<std::string> alarmAttributes(const std::string& instance,
+                                         const SensorSet::key_type& sensor)
+{
+    static constexpr auto alarms = {"alarm",       "min_alarm",  "max_alarm",
+                                    "lcrit_alarm", "crit_alarm", "fault"};
+
+    std::vector<std::string> found;
+    for (const auto& alarm : alarms)
+    {
+        std::error_code ec;
+        if (std::filesystem::exists(
+                sysfs::make_sysfs_path(instance, sensor.first, sensor.second,
+                                       alarm),
+                ec))
+        {
+            found.emplace_back(alarm);
+        }
+    }
+    return found;
+}
+
+AlarmWatch::AlarmWatch(const sdeventplus::Event& event,
+                       hwmonio::Attribute&& attr, Callback&& callback) :
+    _attr(std::move(attr)), _callback(std::move(callback)),
+    // sysfs only notifies pollers that have read the attribute since the
+    // last notification, so read it before polling.
+    _value(_attr.read(hwmonio::retries, hwmonio::delay)),
+    _source(event, _attr.fd(), EPOLLPRI,
+            [this](auto&, int, uint32_t) { notified(); })
+{}
+
+void AlarmWatch::disable()
+{
+    // Safe from the callback, unlike destroying the watch.
+    _source.set_enabled(sdeventplus::source::Enabled::Off);
+}
+
+void AlarmWatch::enable()
+{
+    _source.set_enabled(sdeventplus::source::Enabled::On);
+}
+
+void AlarmWatch::notified()
+{
+    try
+    {
+        _value = _attr.read(hwmonio::retries, hwmonio::delay);
+    }
+    catch (const std::system_error&)
+    {
+        // Leave the sensor's regular read to report the failure.
+        return;
+    }
+
+    _callback(_value);
+}
+
+} // namespace hwmon
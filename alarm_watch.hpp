@@ -0,0 +1,89 @@
+#pragma once
+
+#include "hwmonio.hpp"
+#include "sensorset.hpp"
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace hwmon
+{
+
+/** @brief Find the alarm and fault attributes of a sensor.
+ *  @details The SensorSet only keeps the first word of an attribute after
+ *  the sensor, temp1_crit_alarm is listed as crit, so the attributes are
+ *  looked for on sysfs instead.
+ *
+ *  @param[in] instance - The hwmon instance path.
+ *  @param[in] sensor - The sensor's sysfs identifiers.
+ *
+ *  @return - The attributes found (ex. crit_alarm).
+ */
+std::vector<std::string> alarmAttributes(const std::string& instance,
+                                         const SensorSet::key_type& sensor);
+
+/** @class AlarmWatch
+ *  @brief Watches an alarm or fault attribute for kernel notifications.
+ *  @details Drivers call sysfs_notify() on attributes such as
+ *  temp1_crit_alarm or fan1_fault when they change, which wakes up
+ *  anything polling them for POLLPRI.  Rather than waiting for the next
+ *  read cycle to notice, the callback runs from the event loop as soon as
+ *  the attribute changes.
+ */
+class AlarmWatch
+{
+  public:
+    /** @brief Called with the attribute's new value. */
+    using Callback = std::function<void(int64_t)>;
+
+    AlarmWatch() = delete;
+    AlarmWatch(const AlarmWatch&) = delete;
+    AlarmWatch& operator=(const AlarmWatch&) = delete;
+    AlarmWatch(AlarmWatch&&) = delete;
+    AlarmWatch& operator=(AlarmWatch&&) = delete;
+    ~AlarmWatch() = default;
+
+    /** @brief Constructor
+     *
+     *  Throws std::system_error if the attribute can't be polled.
+     *
+     *  @param[in] event - The event loop to watch from.
+     *  @param[in] attr - The attribute to watch.
+     *  @param[in] callback - Called when the attribute changes.
+     */
+    AlarmWatch(const sdeventplus::Event& event, hwmonio::Attribute&& attr,
+               Callback&& callback);
+
+    /** @brief Get the value last read from the attribute. */
+    inline int64_t value() const
+    {
+        return _value;
+    }
+
+    /** @brief Stop watching, the attribute having gone away or the
+     *         instance being quiesced. */
+    void disable();
+
+    /** @brief Watch again after disable(), catching up on any change. */
+    void enable();
+
+  private:
+    /** @brief Read the attribute again once notified. */
+    void notified();
+
+    /** @brief The watched attribute. */
+    hwmonio::Attribute _attr;
+    /** @brief Called when the attribute changes. */
+    Callback _callback;
+    /** @brief The value last read. */
+    int64_t _value;
+    /** @brief Polls the attribute for POLLPRI. */
+    sdeventplus::source::IO _source;
+};
+
+} // namespace hwmon
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace hwmon
+{
+
+/** @class AuxCache
+ *  @brief Last value read from an auxiliary attribute of a sensor.
+ *  @details Attributes such as fault or average_interval rarely change, so
+ *  rather than reading them alongside the input every cycle the value is
+ *  kept and only read again once its refresh period has expired.
+ */
+class AuxCache
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Get the cached value if it is still fresh.
+     *
+     *  @param[in] now - The current time.
+     *  @param[in] period - How long a value stays fresh, zero to always
+     *                      read the attribute.
+     *
+     *  @return - The value, std::nullopt if it must be read again.
+     */
+    inline std::optional<int64_t> get(Clock::time_point now,
+                                      Clock::duration period) const
+    {
+        if (!_value || now - _readAt >= period)
+        {
+            return std::nullopt;
+        }
+        return _value;
+    }
+
+    /** @brief Cache a value just read.
+     *
+     *  @param[in] value - The attribute value.
+     *  @param[in] now - When it was read.
+     */
+    inline void set(int64_t value, Clock::time_point now)
+    {
+        _value = value;
+        _readAt = now;
+    }
+
+    /** @brief Force the attribute to be read next time. */
+    inline void invalidate()
+    {
+        _value.reset();
+    }
+
+  private:
+    /** @brief The last value read. */
+    std::optional<int64_t> _value;
+    /** @brief When _value was read. */
+    Clock::time_point _readAt;
+};
+
+} // namespace hwmon
@@ -0,0 +1,212 @@
+#include "bus_lock.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <filesystem>
+#include <regex>
+#include <system_error>
+#include <utility>
+
+namespace hwmon
+{
+
+namespace
+{
+
+/** @brief Where the ticket counter is in the lock file. */
+constexpr off_t counterOffset = 0;
+
+/** @brief Where the bytes locked by the tickets start in the lock file. */
+constexpr off_t ticketOffset = 4096;
+
+/** @brief Set or clear an OFD lock on a range of the lock file.
+ *
+ *  @return - 0, or the errno.
+ */
+int rangeLock(int fd, int cmd, short type, off_t start, off_t len)
+{
+    struct flock fl{};
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = start;
+    fl.l_len = len;
+    while (::fcntl(fd, cmd, &fl) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return errno;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+std::optional<int> i2cBus(const std::string& devPath)
+{
+    // The innermost bus, a device behind a mux is on the mux's channel.
+    static const std::regex re{"/i2c-([0-9]+)/[0-9]+-[0-9a-f]{4}(?=/|$)"};
+
+    std::optional<int> bus;
+    for (auto it = std::sregex_iterator(devPath.begin(), devPath.end(), re);
+         it != std::sregex_iterator(); ++it)
+    {
+        bus = std::stoi((*it)[1]);
+    }
+    return bus;
+}
+
+BusLock::BusLock(const std::string& path, Clock::duration maxHold) :
+    _maxHold(maxHold)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(
+        std::filesystem::path(path).parent_path(), ec);
+
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (_fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+}
+
+BusLock::~BusLock()
+{
+    ::close(_fd);
+}
+
+std::string BusLock::path(int bus)
+{
+    return std::string(directory) + "/i2c-" + std::to_string(bus) + ".lock";
+}
+
+BusLock::Attempt BusLock::lock(Clock::duration timeout)
+{
+    if (_since)
+    {
+        if (Clock::now() - *_since < _maxHold)
+        {
+            return {State::held, std::nullopt};
+        }
+
+        // Go to the back of the queue, so anyone waiting has a turn first.
+        unlock();
+    }
+
+    takeTicket();
+    auto now = Clock::now();
+    if (tryTake())
+    {
+        std::optional<Clock::duration> waited;
+        if (_waitingSince)
+        {
+            waited = now - *std::exchange(_waitingSince, std::nullopt);
+        }
+        return {State::held, waited};
+    }
+
+    if (!_waitingSince)
+    {
+        _waitingSince = now;
+    }
+    auto waited = now - *_waitingSince;
+    if (waited >= timeout)
+    {
+        dropTicket();
+        return {State::timedOut, waited};
+    }
+    return {State::waiting, std::nullopt};
+}
+
+void BusLock::unlock()
+{
+    if (_since)
+    {
+        ::flock(_fd, LOCK_UN);
+        _since.reset();
+    }
+    dropTicket();
+}
+
+void BusLock::takeTicket()
+{
+    if (_ticket)
+    {
+        return;
+    }
+
+    // The counter is only locked for as long as it takes to bump it.
+    auto rc = rangeLock(_fd, F_OFD_SETLKW, F_WRLCK, counterOffset,
+                        sizeof(uint64_t));
+    if (rc != 0)
+    {
+        throw std::system_error(rc, std::generic_category(), "bus lock");
+    }
+
+    uint64_t ticket = 0;
+    if (::pread(_fd, &ticket, sizeof(ticket), counterOffset) !=
+        sizeof(ticket))
+    {
+        ticket = 0;
+    }
+    auto next = ticket + 1;
+    if (::pwrite(_fd, &next, sizeof(next), counterOffset) != sizeof(next))
+    {
+        rc = errno;
+    }
+
+    // Lock the ticket's byte before anyone else can take a later ticket,
+    // so the later ones wait for it.
+    if (rc == 0)
+    {
+        rc = rangeLock(_fd, F_OFD_SETLK, F_WRLCK, ticketOffset + ticket, 1);
+    }
+    rangeLock(_fd, F_OFD_SETLK, F_UNLCK, counterOffset, sizeof(uint64_t));
+    if (rc != 0)
+    {
+        throw std::system_error(rc, std::generic_category(), "bus lock");
+    }
+
+    _ticket = ticket;
+}
+
+void BusLock::dropTicket()
+{
+    if (_ticket)
+    {
+        rangeLock(_fd, F_OFD_SETLK, F_UNLCK, ticketOffset + *_ticket, 1);
+        _ticket.reset();
+    }
+    _waitingSince.reset();
+}
+
+bool BusLock::tryTake()
+{
+    if (*_ticket > 0)
+    {
+        // OFD locks of this file description don't show, only those of
+        // the tickets before this one.
+        struct flock fl{};
+        fl.l_type = F_WRLCK;
+        fl.l_whence = SEEK_SET;
+        fl.l_start = ticketOffset;
+        fl.l_len = static_cast<off_t>(*_ticket);
+        if (::fcntl(_fd, F_OFD_GETLK, &fl) < 0 || fl.l_type != F_UNLCK)
+        {
+            return false;
+        }
+    }
+
+    if (::flock(_fd, LOCK_EX | LOCK_NB) < 0)
+    {
+        return false;
+    }
+
+    _since = Clock::now();
+    return true;
+}
+
+} // namespace hwmon
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace hwmon
+{
+
+/** @brief Find the I2C bus a device is on.
+ *
+ *  @param[in] devPath - The device's sysfs path, ex.
+ *                       /sys/devices/platform/ahb/1e78a000.i2c/i2c-3/3-004c
+ *
+ *  @return - The bus number, std::nullopt if not an I2C device.
+ */
+std::optional<int> i2cBus(const std::string& devPath);
+
+/** @class BusLock
+ *  @brief A lock on an I2C bus shared with other processes.
+ *  @details The lock is an flock() on a file named after the bus, so any
+ *  process polling or updating devices on the bus can take part, and the
+ *  kernel drops the lock of a process that dies holding it.  The lock is
+ *  held across a batch of reads but for no longer than the maximum hold
+ *  time, after which it is handed to the waiters before it is taken again.
+ *
+ *  The handoff is first come, first served between BusLocks: each takes a
+ *  ticket, a counter in the lock file, and holds an OFD lock on the byte
+ *  at an offset from the ticket until it releases the bus lock.  A ticket
+ *  gets its turn once none of the bytes of the tickets before it are
+ *  locked.  Processes that only use flock() aren't queued, they get the
+ *  lock whenever it's free.
+ */
+class BusLock
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Where the lock files of the buses are. */
+    static constexpr auto directory = "/run/hwmon";
+
+    /** @brief How often to try again for a contended lock. */
+    static constexpr auto retryInterval = std::chrono::milliseconds(1);
+
+    /** @brief Where an attempt to take the lock got to. */
+    enum class State
+    {
+        held,
+        waiting,
+        timedOut,
+    };
+
+    /** @brief The outcome of an attempt to take the lock. */
+    struct Attempt
+    {
+        State state;
+        /** @brief How long the lock was waited for, once taken or given
+         *         up on after waiting, std::nullopt otherwise. */
+        std::optional<Clock::duration> waited;
+    };
+
+    BusLock() = delete;
+    BusLock(const BusLock&) = delete;
+    BusLock& operator=(const BusLock&) = delete;
+    BusLock(BusLock&&) = delete;
+    BusLock& operator=(BusLock&&) = delete;
+    ~BusLock();
+
+    /** @brief Constructor
+     *
+     *  @param[in] path - The lock file, created if it doesn't exist.
+     *  @param[in] maxHold - The longest to hold the lock for at a time.
+     *
+     *  @throws std::system_error if the lock file can't be opened.
+     */
+    BusLock(const std::string& path, Clock::duration maxHold);
+
+    /** @brief Get the lock file of an I2C bus.
+     *
+     *  @param[in] bus - The bus number.
+     */
+    static std::string path(int bus);
+
+    /** @brief Try to take the lock, unless already held, without blocking.
+     *
+     *  If it has been held for longer than the maximum hold time it is
+     *  released and taken again after anyone already waiting for it.  A
+     *  contended lock keeps its place in the queue, and is tried again by
+     *  calling lock() again, every retryInterval or so.  Gives up once
+     *  the timeout has passed since the first attempt, leaving the lock
+     *  not held.
+     *
+     *  @param[in] timeout - The longest to wait for the lock.
+     *
+     *  @return - Whether the lock was taken, and how long it waited.
+     *
+     *  @throws std::system_error if a ticket can't be taken.
+     */
+    Attempt lock(Clock::duration timeout);
+
+    /** @brief Release the lock, if held. */
+    void unlock();
+
+    /** @brief Whether the lock is held. */
+    inline bool held() const
+    {
+        return _since.has_value();
+    }
+
+  private:
+    /** @brief Take a ticket and lock its byte. */
+    void takeTicket();
+
+    /** @brief Release the ticket, if any. */
+    void dropTicket();
+
+    /** @brief Take the lock if it's the ticket's turn and it's free. */
+    bool tryTake();
+
+    /** @brief The lock file. */
+    int _fd = -1;
+    /** @brief The longest to hold the lock for at a time. */
+    Clock::duration _maxHold;
+    /** @brief When the lock was taken, if held. */
+    std::optional<Clock::time_point> _since;
+    /** @brief The ticket, while waiting for or holding the lock. */
+    std::optional<uint64_t> _ticket;
+    /** @brief When the first attempt failed, while waiting. */
+    std::optional<Clock::time_point> _waitingSince;
+};
+
+} // namespace hwmon
@@ -0,0 +1,203 @@
+#include "control.hpp"
+
+#include "fan_pwm.hpp"
+#include "fan_speed.hpp"
+#include "interface.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace hwmon
+{
+
+namespace
+{
+
+/** @brief Whether a statistic signals its changes.
+ *  @details The ones updated on nearly every wait or tick would flood the
+ *  bus, they can still be read whenever needed.
+ */
+bool emitsChange(std::string_view property)
+{
+    return property != Control::busLockWaitTime &&
+           property != Control::periodJitter;
+}
+
+} // namespace
+
+void quiesceObject(InterfaceMap& obj, bool quiesced)
+{
+    for (auto& [type, iface] : obj)
+    {
+        switch (type)
+        {
+            case InterfaceType::VALUE:
+                if (quiesced)
+                {
+                    std::any_cast<std::shared_ptr<ValueObject>&>(iface)->value(
+                        std::numeric_limits<double>::quiet_NaN());
+                }
+                break;
+            case InterfaceType::FAN_SPEED:
+                std::any_cast<std::shared_ptr<FanSpeed>&>(iface)->quiesce(
+                    quiesced);
+                break;
+            case InterfaceType::FAN_PWM:
+                std::any_cast<std::shared_ptr<FanPwm>&>(iface)->quiesce(
+                    quiesced);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+const sdbusplus::vtable_t Control::_vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("Quiesce", "t", "", quiesceMethod),
+    sdbusplus::vtable::method("Resume", "", "", resumeMethod),
+    sdbusplus::vtable::property("Quiesced", "b", getQuiesced,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(cycleOverruns, "t", getStatistic,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(deferredReads, "t", getStatistic,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(maxCycleTime, "t", getStatistic,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(skippedTicks, "t", getStatistic,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(periodJitter, "t", getStatistic,
+                                sdbusplus::vtable::property_::none),
+    sdbusplus::vtable::property(busLockWaits, "t", getStatistic,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(busLockWaitTime, "t", getStatistic,
+                                sdbusplus::vtable::property_::none),
+    sdbusplus::vtable::property(busLockMaxWait, "t", getStatistic,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(busLockTimeouts, "t", getStatistic,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(effectiveInterval, "t", getStatistic,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::end()};
+
+Control::Control(sdbusplus::bus_t& bus, const char* path,
+                 const sdeventplus::Event& event, Callback&& callback) :
+    _callback(std::move(callback)),
+    _interface(bus, path, interface, _vtable, this),
+    _timer(event, [this](auto&) { resume(); })
+{}
+
+void Control::quiesce(std::chrono::milliseconds timeout)
+{
+    _timer.restartOnce(timeout);
+    if (_quiesced)
+    {
+        return;
+    }
+
+    _quiesced = true;
+    _drained = false;
+    _callback(true);
+}
+
+void Control::resume()
+{
+    _timer.setEnabled(false);
+    if (!_quiesced)
+    {
+        return;
+    }
+
+    _quiesced = false;
+    if (std::exchange(_drained, false))
+    {
+        _interface.property_changed("Quiesced");
+    }
+    _callback(false);
+}
+
+void Control::drained()
+{
+    if (_quiesced && !_drained)
+    {
+        _drained = true;
+        _interface.property_changed("Quiesced");
+    }
+}
+
+void Control::add(const char* property, uint64_t count)
+{
+    set(property, get(property) + count);
+}
+
+void Control::set(const char* property, uint64_t value)
+{
+    auto& statistic = _statistics[property];
+    if (statistic != value)
+    {
+        statistic = value;
+        if (emitsChange(property))
+        {
+            _interface.property_changed(property);
+        }
+    }
+}
+
+uint64_t Control::get(const char* property) const
+{
+    auto it = _statistics.find(property);
+    return it == _statistics.end() ? 0 : it->second;
+}
+
+int Control::quiesceMethod(sd_bus_message* msg, void* context, sd_bus_error*)
+{
+    sdbusplus::message_t m(msg);
+    uint64_t timeout = 0;
+    m.read(timeout);
+
+    // Always time out, a client that goes away mustn't leave the sensors
+    // paused forever.
+    if (timeout == 0)
+    {
+        return -EINVAL;
+    }
+
+    static_cast<Control*>(context)->quiesce(
+        std::chrono::milliseconds(timeout));
+
+    m.new_method_return().method_return();
+    return 1;
+}
+
+int Control::resumeMethod(sd_bus_message* msg, void* context, sd_bus_error*)
+{
+    sdbusplus::message_t m(msg);
+    static_cast<Control*>(context)->resume();
+
+    m.new_method_return().method_return();
+    return 1;
+}
+
+int Control::getQuiesced(sd_bus*, const char*, const char*, const char*,
+                         sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto control = static_cast<Control*>(context);
+    sdbusplus::message_t m(reply);
+    m.append(control->_quiesced && control->_drained);
+    return 1;
+}
+
+int Control::getStatistic(sd_bus*, const char*, const char*,
+                          const char* property, sd_bus_message* reply,
+                          void* context, sd_bus_error*)
+{
+    sdbusplus::message_t m(reply);
+    m.append(static_cast<Control*>(context)->get(property));
+    return 1;
+}
+
+} // namespace hwmon
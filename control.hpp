@@ -0,0 +1,165 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server.hpp>
+#include <sdbusplus/vtable.hpp>
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace hwmon
+{
+
+/** @brief Pause or resume a sensor's D-Bus objects.
+ *
+ *  While quiesced the value reads as NaN, as it isn't read anymore, and
+ *  fan targets are held.  Resuming writes out the held targets, the value
+ *  is left for the next read.
+ *
+ *  @param[in] obj - The sensor's interfaces.
+ *  @param[in] quiesced - Whether the instance is quiesced.
+ */
+void quiesceObject(InterfaceMap& obj, bool quiesced);
+
+/** @class Control
+ *  @brief Instance wide control methods on D-Bus.
+ *  @details Implements xyz.openbmc_project.Hwmon.Control.  Quiesce(t)
+ *  pauses reading the sensors and writing fan targets for the given number
+ *  of milliseconds, without removing any objects, and Resume() ends the
+ *  pause early.  Quiescing again while quiesced restarts the timeout.
+ *  The Quiesced property only turns true once the reads already in flight
+ *  have drained, so a client can tell when the device is left alone.
+ *  The remaining properties are statistics for monitoring the poller.
+ */
+class Control
+{
+  public:
+    /** @brief Called with the new state when quiesced or resumed. */
+    using Callback = std::function<void(bool)>;
+
+    static constexpr auto interface = "xyz.openbmc_project.Hwmon.Control";
+
+    /** @brief Read cycles that ran past their interval. */
+    static constexpr auto cycleOverruns = "CycleOverruns";
+    /** @brief Sensor reads deferred to a later cycle. */
+    static constexpr auto deferredReads = "DeferredReads";
+    /** @brief Longest read cycle, in microseconds. */
+    static constexpr auto maxCycleTime = "MaxCycleTime";
+    /** @brief Read timer ticks missed or dropped by an overrun. */
+    static constexpr auto skippedTicks = "SkippedTicks";
+    /** @brief Mean error of the read timer's period, in microseconds.
+     *         Its changes aren't signalled. */
+    static constexpr auto periodJitter = "PeriodJitter";
+    /** @brief Times the bus lock was found taken. */
+    static constexpr auto busLockWaits = "BusLockWaits";
+    /** @brief Total time spent waiting for the bus lock, in microseconds.
+     *         Its changes aren't signalled. */
+    static constexpr auto busLockWaitTime = "BusLockWaitTime";
+    /** @brief Longest wait for the bus lock, in microseconds. */
+    static constexpr auto busLockMaxWait = "BusLockMaxWait";
+    /** @brief Batches of reads skipped because the bus lock timed out. */
+    static constexpr auto busLockTimeouts = "BusLockTimeouts";
+    /** @brief Poll interval after rate control, in microseconds. */
+    static constexpr auto effectiveInterval = "EffectiveInterval";
+
+    Control() = delete;
+    Control(const Control&) = delete;
+    Control& operator=(const Control&) = delete;
+    Control(Control&&) = delete;
+    Control& operator=(Control&&) = delete;
+    ~Control() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] bus - The bus to put the interface on.
+     *  @param[in] path - The object path to put it at.
+     *  @param[in] event - The event loop to run the timeout on.
+     *  @param[in] callback - Called when quiesced or resumed.
+     */
+    Control(sdbusplus::bus_t& bus, const char* path,
+            const sdeventplus::Event& event, Callback&& callback);
+
+    /** @brief Pause reads and target writes.
+     *
+     *  @param[in] timeout - When to resume by itself.
+     */
+    void quiesce(std::chrono::milliseconds timeout);
+
+    /** @brief End a pause. */
+    void resume();
+
+    /** @brief Whether reads and target writes are paused. */
+    inline bool quiesced() const
+    {
+        return _quiesced;
+    }
+
+    /** @brief Report that nothing is accessing the device anymore since
+     *         the instance was quiesced. */
+    void drained();
+
+    /** @brief Add to a statistic.
+     *
+     *  @param[in] property - The statistic's property name.
+     *  @param[in] count - The amount to add.
+     */
+    void add(const char* property, uint64_t count = 1);
+
+    /** @brief Set a statistic.
+     *
+     *  @param[in] property - The statistic's property name.
+     *  @param[in] value - The new value.
+     */
+    void set(const char* property, uint64_t value);
+
+    /** @brief Get a statistic.
+     *
+     *  @param[in] property - The statistic's property name.
+     */
+    uint64_t get(const char* property) const;
+
+  private:
+    /** @brief Quiesce method handler. */
+    static int quiesceMethod(sd_bus_message* msg, void* context,
+                             sd_bus_error* error);
+
+    /** @brief Resume method handler. */
+    static int resumeMethod(sd_bus_message* msg, void* context,
+                            sd_bus_error* error);
+
+    /** @brief Quiesced property getter. */
+    static int getQuiesced(sd_bus* bus, const char* path, const char* intf,
+                           const char* property, sd_bus_message* reply,
+                           void* context, sd_bus_error* error);
+
+    /** @brief Statistic property getter. */
+    static int getStatistic(sd_bus* bus, const char* path, const char* intf,
+                            const char* property, sd_bus_message* reply,
+                            void* context, sd_bus_error* error);
+
+    /** @brief The interface's methods and properties. */
+    static const sdbusplus::vtable_t _vtable[];
+
+    /** @brief Called when quiesced or resumed. */
+    Callback _callback;
+    /** @brief The interface on the bus. */
+    sdbusplus::server::interface_t _interface;
+    /** @brief The statistics, by property name. */
+    std::map<std::string, uint64_t> _statistics;
+    /** @brief Whether reads and target writes are paused. */
+    bool _quiesced = false;
+    /** @brief Whether the reads in flight when quiesced have finished. */
+    bool _drained = false;
+    /** @brief Resumes when the quiesce timeout expires. */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> _timer;
+};
+
+} // namespace hwmon
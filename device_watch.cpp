@@ -0,0 +1,197 @@
+#include "device_watch.hpp"
+
+#include <linux/netlink.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <filesystem>
+#include <system_error>
+
+namespace hwmon
+{
+
+namespace
+{
+
+/** @brief The multicast group the kernel sends uevents to. */
+constexpr uint32_t kernelGroup = 1;
+
+/** @brief Open a netlink socket receiving kernel uevents. */
+int openSocket()
+{
+    auto fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                       NETLINK_KOBJECT_UEVENT);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "uevent socket");
+    }
+
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = kernelGroup;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        auto rc = errno;
+        ::close(fd);
+        throw std::system_error(rc, std::generic_category(), "uevent socket");
+    }
+
+    return fd;
+}
+
+} // namespace
+
+std::optional<Uevent> parseUevent(std::string_view msg)
+{
+    Uevent uevent;
+
+    // The header, ACTION@DEVPATH, is followed by the same as KEY=value
+    // pairs.
+    auto end = msg.find('\0');
+    if (end == std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+    msg.remove_prefix(end + 1);
+
+    while (!msg.empty())
+    {
+        end = msg.find('\0');
+        auto field = msg.substr(0, end);
+        msg.remove_prefix(end == std::string_view::npos ? msg.size()
+                                                        : end + 1);
+
+        auto eq = field.find('=');
+        if (eq == std::string_view::npos)
+        {
+            continue;
+        }
+
+        auto key = field.substr(0, eq);
+        auto value = field.substr(eq + 1);
+        if (key == "ACTION")
+        {
+            uevent.action = value;
+        }
+        else if (key == "DEVPATH")
+        {
+            uevent.devpath = value;
+        }
+        else if (key == "SUBSYSTEM")
+        {
+            uevent.subsystem = value;
+        }
+    }
+
+    if (uevent.action.empty() || uevent.devpath.empty())
+    {
+        return std::nullopt;
+    }
+    return uevent;
+}
+
+std::string instanceOf(std::string_view devpath, std::string_view device)
+{
+    static constexpr std::string_view sys = "/sys";
+    static constexpr std::string_view hwmon = "/hwmon/";
+
+    if (!device.starts_with(sys))
+    {
+        return {};
+    }
+    device.remove_prefix(sys.size());
+
+    if (!devpath.starts_with(device))
+    {
+        return {};
+    }
+    devpath.remove_prefix(device.size());
+
+    if (!devpath.starts_with(hwmon))
+    {
+        return {};
+    }
+    devpath.remove_prefix(hwmon.size());
+
+    if (!devpath.starts_with("hwmon") ||
+        devpath.find('/') != std::string_view::npos)
+    {
+        return {};
+    }
+    return std::string(devpath);
+}
+
+std::string findInstance(const std::string& device)
+{
+    std::error_code ec;
+    for (const auto& e :
+         std::filesystem::directory_iterator(device + "/hwmon", ec))
+    {
+        auto name = e.path().filename().string();
+        if (name.starts_with("hwmon"))
+        {
+            return name;
+        }
+    }
+    return {};
+}
+
+DeviceWatch::DeviceWatch(const sdeventplus::Event& event,
+                         const std::string& device, Callback&& callback) :
+    _device(device), _callback(std::move(callback)), _fd(openSocket()),
+    _source(event, _fd, EPOLLIN, [this](auto&, int, uint32_t) { receive(); })
+{}
+
+DeviceWatch::~DeviceWatch()
+{
+    ::close(_fd);
+}
+
+void DeviceWatch::receive()
+{
+    // Uevents can be several KB with all of their variables.
+    std::array<char, 8192> buf;
+
+    while (true)
+    {
+        sockaddr_nl addr{};
+        socklen_t len = sizeof(addr);
+        auto n = ::recvfrom(_fd, buf.data(), buf.size(), 0,
+                            reinterpret_cast<sockaddr*>(&addr), &len);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == ENOBUFS)
+            {
+                // Uevents lost to an overrun are made up for by the caller
+                // looking for the instance itself.
+                continue;
+            }
+            return;
+        }
+
+        // Only trust uevents from the kernel.
+        if (addr.nl_pid != 0)
+        {
+            continue;
+        }
+
+        auto uevent = parseUevent(std::string_view(buf.data(), n));
+        if (!uevent || uevent->subsystem != "hwmon" ||
+            (uevent->action != "add" && uevent->action != "remove"))
+        {
+            continue;
+        }
+
+        auto instance = instanceOf(uevent->devpath, _device);
+        if (!instance.empty())
+        {
+            _callback(uevent->action == "add", instance);
+        }
+    }
+}
+
+} // namespace hwmon
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace hwmon
+{
+
+/** @brief The fields of a kernel uevent used to follow hwmon instances. */
+struct Uevent
+{
+    std::string action;
+    std::string devpath;
+    std::string subsystem;
+};
+
+/** @brief Parse a kernel uevent message.
+ *
+ *  @param[in] msg - The message, a header then NUL separated KEY=value
+ *                   pairs.
+ *
+ *  @return - The uevent, std::nullopt if it has no ACTION or DEVPATH.
+ */
+std::optional<Uevent> parseUevent(std::string_view msg);
+
+/** @brief Get the hwmon instance of a device a uevent is about.
+ *
+ *  @param[in] devpath - The uevent's DEVPATH, relative to /sys.
+ *  @param[in] device - The device's sysfs path (ex. /sys/devices/...).
+ *
+ *  @return - The instance (ex. hwmon3), empty if the uevent isn't about
+ *            a hwmon instance of the device.
+ */
+std::string instanceOf(std::string_view devpath, std::string_view device);
+
+/** @brief Find the hwmon instance of a device.
+ *
+ *  @param[in] device - The device's sysfs path (ex. /sys/devices/...).
+ *
+ *  @return - The instance (ex. hwmon3), empty if the device has none.
+ */
+std::string findInstance(const std::string& device);
+
+/** @class DeviceWatch
+ *  @brief Watches a device's hwmon instance come and go.
+ *  @details Kernel uevents are received as the driver is unbound from and
+ *  bound to the device again, and the hwmon instance removed and added.
+ *  The new instance may not have the same index as the old one.
+ */
+class DeviceWatch
+{
+  public:
+    /** @brief Called with whether an instance was added or removed, and
+     *         the instance. */
+    using Callback = std::function<void(bool, const std::string&)>;
+
+    DeviceWatch() = delete;
+    DeviceWatch(const DeviceWatch&) = delete;
+    DeviceWatch& operator=(const DeviceWatch&) = delete;
+    DeviceWatch(DeviceWatch&&) = delete;
+    DeviceWatch& operator=(DeviceWatch&&) = delete;
+    ~DeviceWatch();
+
+    /** @brief Constructor
+     *
+     *  Throws std::system_error if uevents can't be received.
+     *
+     *  @param[in] event - The event loop to watch from.
+     *  @param[in] device - The device's sysfs path (ex. /sys/devices/...).
+     *  @param[in] callback - Called when an instance is added or removed.
+     */
+    DeviceWatch(const sdeventplus::Event& event, const std::string& device,
+                Callback&& callback);
+
+    /** @brief The device's sysfs path. */
+    inline const std::string& device() const
+    {
+        return _device;
+    }
+
+  private:
+    /** @brief Receive the uevents queued on the socket. */
+    void receive();
+
+    /** @brief The device's sysfs path. */
+    std::string _device;
+    /** @brief Called when an instance is added or removed. */
+    Callback _callback;
+    /** @brief The uevent netlink socket. */
+    int _fd;
+    /** @brief Polls the socket for uevents. */
+    sdeventplus::source::IO _source;
+};
+
+} // namespace hwmon
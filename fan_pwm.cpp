@@ -3,52 +3,100 @@
 #include "env.hpp"
 #include "hwmon.hpp"
 #include "hwmonio.hpp"
+#include "recovery.hpp"
+#include "rt.hpp"
 #include "sensorset.hpp"
 #include "sysfs.hpp"
 
-#include <phosphor-logging/elog-errors.hpp>
-#include <xyz/openbmc_project/Control/Device/error.hpp>
-
 #include <filesystem>
-#include <format>
 #include <string>
 
-using namespace phosphor::logging;
-
 namespace hwmon
 {
 
 uint64_t FanPwm::target(uint64_t value)
 {
-    using namespace std::literals;
+    if (_quiesced || degraded())
+    {
+        _held = true;
+        return FanPwmObject::target(value);
+    }
+
+    if (_writer)
+    {
+        // Written out from the event loop, which also reports any failure.
+        _writer->set(value);
+        return FanPwmObject::target(value);
+    }
 
-    std::string empty;
     // Write target out to sysfs
     try
     {
-        _ioAccess->write(value, _type, _id, empty, hwmonio::retries,
-                         hwmonio::delay);
+        write(value);
     }
     catch (const std::system_error& e)
     {
-        using namespace sdbusplus::xyz::openbmc_project::Control::Device::Error;
-        report<WriteFailure>(
-            xyz::openbmc_project::Control::Device::WriteFailure::CALLOUT_ERRNO(
-                e.code().value()),
-            xyz::openbmc_project::Control::Device::WriteFailure::
-                CALLOUT_DEVICE_PATH(_devPath.c_str()));
+        writeFailure(e);
+    }
 
-        auto file =
-            sysfs::make_sysfs_path(_ioAccess->path(), _type, _id, empty);
+    return FanPwmObject::target(value);
+}
 
-        log<level::INFO>(std::format("Failing sysfs file: {} errno: {}", file,
-                                     e.code().value())
-                             .c_str());
+void FanPwm::release()
+{
+    if (_held)
+    {
+        _held = false;
+        target(FanPwmObject::target());
+    }
+}
 
-        exit(EXIT_FAILURE);
+void FanPwm::quiesce(bool quiesced)
+{
+    _quiesced = quiesced;
+    if (!quiesced)
+    {
+        release();
+        return;
     }
 
-    return FanPwmObject::target(value);
+    if (_writer && _writer->cancel())
+    {
+        _held = true;
+    }
+}
+
+void FanPwm::rebind(std::unique_ptr<hwmonio::HwmonIOInterface> io)
+{
+    _ioAccess = std::move(io);
+    if (_attr)
+    {
+        _attr = rt::openAttribute(sysfs::make_sysfs_path(
+            _ioAccess->path(), _type, _id, ""));
+    }
+}
+
+void FanPwm::write(uint64_t value)
+{
+    if (_attr)
+    {
+        _attr->write(value, hwmonio::retries, hwmonio::delay);
+        return;
+    }
+
+    std::string empty;
+    _ioAccess->write(value, _type, _id, empty, hwmonio::retries,
+                     hwmonio::delay);
+}
+
+void FanPwm::writeFailure(const std::system_error& e)
+{
+    std::string empty;
+    auto file = sysfs::make_sysfs_path(_ioAccess->path(), _type, _id, empty);
+    targetWriteFailed(e, _devPath, file);
+
+    // Written again once the device is back.
+    _held = true;
 }
 
 } // namespace hwmon
@@ -2,9 +2,13 @@
 
 #include "hwmonio.hpp"
 #include "interface.hpp"
+#include "rt.hpp"
 #include "sysfs.hpp"
+#include "target_writer.hpp"
 
 #include <memory>
+#include <optional>
+#include <system_error>
 
 namespace hwmon
 {
@@ -35,19 +39,73 @@ class FanPwm : public FanPwmObject
         FanPwmObject(bus, objPath,
                      defer ? FanPwmObject::action::emit_no_signals
                            : FanPwmObject::action::emit_object_added),
-        _id(id), _ioAccess(std::move(io)), _devPath(devPath)
+        _id(id), _ioAccess(std::move(io)), _devPath(devPath),
+        _writer(TargetWriter::fromEnv(
+            [this](uint64_t value) { write(value); },
+            [this](const std::system_error& e) { writeFailure(e); }))
     {
         FanPwmObject::target(target);
+
+        if (rt::enabled())
+        {
+            _attr = rt::openAttribute(
+                sysfs::make_sysfs_path(_ioAccess->path(), _type, _id, ""));
+        }
     }
 
     /**
      * @brief Set the value of target
      *
+     * @details The value is written to sysfs right away, unless a
+     * TargetWriter has been configured to write it later.  While the
+     * instance is quiesced or the device degraded it is held until
+     * release() is called.
+     *
      * @return Value of target
      */
     uint64_t target(uint64_t value) override;
 
+    /**
+     * @brief Write out a target held while quiesced or degraded
+     */
+    void release();
+
+    /**
+     * @brief Hold the target while the instance is quiesced
+     *
+     * @details A value waiting to be written by the TargetWriter is held
+     * too.  Resuming writes out the held target.
+     *
+     * @param[in] quiesced - Whether the instance is quiesced
+     */
+    void quiesce(bool quiesced);
+
+    /**
+     * @brief Write through a new hwmon instance once the driver has been
+     *        bound to the device again
+     *
+     * @param[in] io - HwmonIO(new instance path)
+     */
+    void rebind(std::unique_ptr<hwmonio::HwmonIOInterface> io);
+
   private:
+    /**
+     * @brief Write the target value to sysfs
+     *
+     * @param[in] value - The target value
+     */
+    void write(uint64_t value);
+
+    /**
+     * @brief Report a failed target write and exit
+     *
+     * @details Returns instead, holding the target, while the device is
+     * being recovered or the driver was unbound.
+     *
+     * @param[in] e - The write error
+     */
+    void writeFailure(const std::system_error& e);
+
     /** @brief hwmon type */
     static constexpr auto _type = "pwm";
     /** @brief hwmon id */
@@ -56,6 +114,14 @@ class FanPwm : public FanPwmObject
     std::unique_ptr<hwmonio::HwmonIOInterface> _ioAccess;
     /** @brief Physical device path. */
     std::string _devPath;
+    /** @brief Optional write-behind for the target. */
+    std::unique_ptr<TargetWriter> _writer;
+    /** @brief Target attribute kept open in real-time mode. */
+    std::optional<hwmonio::Attribute> _attr;
+    /** @brief A target was set while quiesced or degraded. */
+    bool _held = false;
+    /** @brief Whether the instance is quiesced. */
+    bool _quiesced = false;
 };
 
 } // namespace hwmon
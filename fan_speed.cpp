@@ -3,6 +3,8 @@
 #include "env.hpp"
 #include "hwmon.hpp"
 #include "hwmonio.hpp"
+#include "recovery.hpp"
+#include "rt.hpp"
 #include "sensorset.hpp"
 #include "sysfs.hpp"
 
@@ -18,31 +20,85 @@ namespace hwmon
 
 uint64_t FanSpeed::target(uint64_t value)
 {
+    if (_quiesced || degraded())
+    {
+        _held = true;
+        return FanSpeedObject::target(value);
+    }
+
+    if (_writer)
+    {
+        // Written out from the event loop, which also reports any failure.
+        _writer->set(value);
+        return FanSpeedObject::target(value);
+    }
+
     try
     {
-        _ioAccess->write(value, _type, _id, entry::target, hwmonio::retries,
-                         hwmonio::delay);
+        write(value);
     }
     catch (const std::system_error& e)
     {
-        using namespace sdbusplus::xyz::openbmc_project::Control::Device::Error;
-        report<WriteFailure>(
-            xyz::openbmc_project::Control::Device::WriteFailure::CALLOUT_ERRNO(
-                e.code().value()),
-            xyz::openbmc_project::Control::Device::WriteFailure::
-                CALLOUT_DEVICE_PATH(_devPath.c_str()));
+        writeFailure(e);
+    }
 
-        auto file = sysfs::make_sysfs_path(_ioAccess->path(), _type, _id,
-                                           entry::target);
+    return FanSpeedObject::target(value);
+}
 
-        log<level::INFO>(std::format("Failing sysfs file: {} errno: {}", file,
-                                     e.code().value())
-                             .c_str());
+void FanSpeed::release()
+{
+    if (_held)
+    {
+        _held = false;
+        target(FanSpeedObject::target());
+    }
+}
 
-        exit(EXIT_FAILURE);
+void FanSpeed::quiesce(bool quiesced)
+{
+    _quiesced = quiesced;
+    if (!quiesced)
+    {
+        release();
+        return;
     }
 
-    return FanSpeedObject::target(value);
+    if (_writer && _writer->cancel())
+    {
+        _held = true;
+    }
+}
+
+void FanSpeed::rebind(std::unique_ptr<hwmonio::HwmonIOInterface> io)
+{
+    _ioAccess = std::move(io);
+    if (_attr)
+    {
+        _attr = rt::openAttribute(sysfs::make_sysfs_path(
+            _ioAccess->path(), _type, _id, entry::target));
+    }
+}
+
+void FanSpeed::write(uint64_t value)
+{
+    if (_attr)
+    {
+        _attr->write(value, hwmonio::retries, hwmonio::delay);
+        return;
+    }
+
+    _ioAccess->write(value, _type, _id, entry::target, hwmonio::retries,
+                     hwmonio::delay);
+}
+
+void FanSpeed::writeFailure(const std::system_error& e)
+{
+    auto file =
+        sysfs::make_sysfs_path(_ioAccess->path(), _type, _id, entry::target);
+    targetWriteFailed(e, _devPath, file);
+
+    // Written again once the device is back.
+    _held = true;
 }
 
 void FanSpeed::enable()
@@ -0,0 +1,66 @@
+#include "gpio_group.hpp"
+
+namespace sensor
+{
+
+GpioGroup::GpioGroup(const sdeventplus::Event& event,
+                     std::shared_ptr<gpioplus::HandleInterface> handle,
+                     std::chrono::milliseconds settle,
+                     std::chrono::milliseconds hold, Read&& read) :
+    _handle(std::move(handle)), _settle(settle), _hold(hold),
+    _read(std::move(read)), _settleTimer(event, [this](auto&) { settled(); }),
+    _holdTimer(event, [this](auto&) { lock(); })
+{}
+
+GpioGroup::~GpioGroup()
+{
+    if (_unlocked)
+    {
+        lock();
+    }
+}
+
+void GpioGroup::start()
+{
+    if (_settleTimer.isEnabled() || _sensors.empty())
+    {
+        return;
+    }
+
+    if (_unlocked)
+    {
+        // Still held open from the last cycle, no need to settle again.
+        _holdTimer.setEnabled(false);
+        settled();
+        return;
+    }
+
+    _handle->setValues({1});
+    _unlocked = true;
+    _settleTimer.restartOnce(_settle);
+}
+
+void GpioGroup::settled()
+{
+    _read(_sensors);
+    release();
+}
+
+void GpioGroup::release()
+{
+    if (_hold.count() > 0)
+    {
+        _holdTimer.restartOnce(_hold);
+        return;
+    }
+
+    lock();
+}
+
+void GpioGroup::lock()
+{
+    _handle->setValues({0});
+    _unlocked = false;
+}
+
+} // namespace sensor
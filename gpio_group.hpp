@@ -0,0 +1,102 @@
+#pragma once
+
+#include "sensorset.hpp"
+
+#include <gpioplus/handle.hpp>
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace sensor
+{
+
+/** @class GpioGroup
+ *  @brief Sensors gated by the same GPIO, read together.
+ *  @details Once per cycle the GPIO is unlocked and, instead of sleeping
+ *  on the main thread, a timer waits for the sensors to settle.  All of the
+ *  group's sensors are then read while the line is held, after which it is
+ *  locked again.  With a hold window the line is left unlocked for that
+ *  long after the reads, so a cycle starting within the window reads the
+ *  group straight away without waiting to settle again.
+ */
+class GpioGroup
+{
+  public:
+    /** @brief Reads the given sensors. */
+    using Read = std::function<void(const std::vector<SensorSet::key_type>&)>;
+
+    GpioGroup() = delete;
+    GpioGroup(const GpioGroup&) = delete;
+    GpioGroup& operator=(const GpioGroup&) = delete;
+    GpioGroup(GpioGroup&&) = delete;
+    GpioGroup& operator=(GpioGroup&&) = delete;
+    ~GpioGroup();
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - The event loop to run the timers on.
+     *  @param[in] handle - The GPIO gating the sensors.
+     *  @param[in] settle - Time for the sensors to settle after unlocking.
+     *  @param[in] hold - Time to leave the GPIO unlocked after the reads.
+     *  @param[in] read - Reads the group's sensors.
+     */
+    GpioGroup(const sdeventplus::Event& event,
+              std::shared_ptr<gpioplus::HandleInterface> handle,
+              std::chrono::milliseconds settle, std::chrono::milliseconds hold,
+              Read&& read);
+
+    /** @brief Forget the sensors read by the group. */
+    inline void clear()
+    {
+        _sensors.clear();
+    }
+
+    /** @brief Add a sensor to be read by the group.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     */
+    inline void add(const SensorSet::key_type& sensor)
+    {
+        _sensors.push_back(sensor);
+    }
+
+    /** @brief Unlock the GPIO and read the sensors once they have settled.
+     *
+     *  Does nothing if the group is still settling from a previous start.
+     */
+    void start();
+
+  private:
+    /** @brief Read the sensors now that they have settled. */
+    void settled();
+
+    /** @brief Lock the GPIO, or hold it open for the hold window. */
+    void release();
+
+    /** @brief Lock the GPIO. */
+    void lock();
+
+    /** @brief The GPIO gating the sensors. */
+    std::shared_ptr<gpioplus::HandleInterface> _handle;
+    /** @brief Time for the sensors to settle. */
+    std::chrono::milliseconds _settle;
+    /** @brief Time to hold the GPIO unlocked after the reads. */
+    std::chrono::milliseconds _hold;
+    /** @brief Reads the sensors. */
+    Read _read;
+    /** @brief The sensors gated by the GPIO. */
+    std::vector<SensorSet::key_type> _sensors;
+    /** @brief Whether the GPIO is unlocked. */
+    bool _unlocked = false;
+    /** @brief Settle timer. */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> _settleTimer;
+    /** @brief Hold window timer. */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> _holdTimer;
+};
+
+} // namespace sensor
@@ -17,48 +17,203 @@
 
 #include "sysfs.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
 #include <exception>
-#include <fstream>
+#include <system_error>
 #include <thread>
+#include <utility>
 
 namespace hwmonio
 {
 
+namespace
+{
+
+/** @brief The error of the last failed system call. */
+std::unexpected<std::error_code> lastError()
+{
+    return std::unexpected(std::error_code(errno, std::generic_category()));
+}
+
+/** @brief Throw an error as read() and write() do, with errno set if the
+ *         error came from the filesystem. */
+[[noreturn]] void raise(const std::error_code& ec)
+{
+    errno = ec.category() == std::generic_category() ? ec.value() : 0;
+    throw std::system_error(ec);
+}
+
+} // namespace
+
+ReadResult FileSystemInterface::tryRead(const std::string& path) const
+{
+    try
+    {
+        return read(path);
+    }
+    catch (const std::exception&)
+    {
+        if (!errno)
+        {
+            throw;
+        }
+        return lastError();
+    }
+}
+
+WriteResult FileSystemInterface::tryWrite(const std::string& path,
+                                          uint32_t value) const
+{
+    try
+    {
+        write(path, value);
+        return {};
+    }
+    catch (const std::exception&)
+    {
+        if (!errno)
+        {
+            throw;
+        }
+        return lastError();
+    }
+}
+
 int64_t FileSystem::read(const std::string& path) const
 {
-    int64_t val;
-    std::ifstream ifs;
-    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit |
-                   std::ifstream::eofbit);
+    auto val = tryRead(path);
+    if (!val)
+    {
+        raise(val.error());
+    }
+    return *val;
+}
+
+void FileSystem::write(const std::string& path, uint32_t value) const
+{
+    auto result = tryWrite(path, value);
+    if (!result)
+    {
+        raise(result.error());
+    }
+}
+
+ReadResult FileSystem::tryRead(const std::string& path) const
+{
+    auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return lastError();
+    }
 
-    errno = 0;
-    if (!ifs.is_open())
-        ifs.open(path);
-    ifs.clear();
-    ifs.seekg(0);
-    ifs >> val;
+    std::array<char, 32> buf;
+    auto n = ::read(fd, buf.data(), buf.size());
+    auto rc = errno;
+    ::close(fd);
+    if (n < 0)
+    {
+        return std::unexpected(std::error_code(rc, std::generic_category()));
+    }
 
+    auto begin = std::find_if_not(buf.data(), buf.data() + n, [](char c) {
+        return std::isspace(static_cast<unsigned char>(c));
+    });
+    int64_t val;
+    auto [ptr, ec] = std::from_chars(begin, buf.data() + n, val);
+    if (ec != std::errc())
+    {
+        // Not a number, as an input stream would fail.
+        return std::unexpected(std::make_error_code(std::io_errc::stream));
+    }
     return val;
 }
 
-void FileSystem::write(const std::string& path, uint32_t value) const
+WriteResult FileSystem::tryWrite(const std::string& path,
+                                 uint32_t value) const
 {
-    std::ofstream ofs;
-    ofs.exceptions(std::ofstream::failbit | std::ofstream::badbit |
-                   std::ofstream::eofbit);
+    auto fd = ::open(path.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return lastError();
+    }
 
-    errno = 0;
-    if (!ofs.is_open())
-        ofs.open(path);
-    ofs.clear();
-    ofs.seekp(0);
-    ofs << value;
-    ofs.flush();
+    std::array<char, 16> buf;
+    auto end = std::to_chars(buf.data(), buf.data() + buf.size(), value).ptr;
+    auto n = ::write(fd, buf.data(), end - buf.data());
+    auto rc = errno;
+    ::close(fd);
+    if (n < 0)
+    {
+        return std::unexpected(std::error_code(rc, std::generic_category()));
+    }
+    return {};
 }
 
 FileSystem fileSystemImpl;
 
+std::optional<std::chrono::milliseconds> readUpdateInterval(
+    const std::string& path, const FileSystemInterface* intf)
+{
+    try
+    {
+        auto interval = intf->read(path + '/' + updateInterval);
+        if (interval > 0)
+        {
+            return std::chrono::milliseconds{interval};
+        }
+    }
+    catch (const std::exception&)
+    {
+        // Not all drivers have an update_interval.
+    }
+
+    return std::nullopt;
+}
+
+bool writeUpdateInterval(const std::string& path,
+                         std::chrono::milliseconds interval,
+                         const FileSystemInterface* intf)
+{
+    try
+    {
+        intf->write(path + '/' + updateInterval, interval.count());
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+/** @brief Retries counted by retryCount(), reads may run on other threads. */
+static std::atomic<uint64_t> retried = 0;
+
+uint64_t retryCount()
+{
+    return retried;
+}
+
+/** @brief Whether to exit once the device is gone, see exitOnRemoval(). */
+static std::atomic<bool> exitWhenGone = true;
+
+void exitOnRemoval(bool exit)
+{
+    exitWhenGone = exit;
+}
+
+bool exitOnRemoval()
+{
+    return exitWhenGone;
+}
+
 static constexpr auto retryableErrors = {
     /*
      * Retry on bus or device errors in case they are transient.
@@ -113,6 +268,52 @@ static constexpr auto retryableErrors = {
      */
     EPROTO};
 
+/** @brief Whether an error from the filesystem is worth retrying. */
+static bool retryable(const std::error_code& ec)
+{
+    return ec.category() == std::generic_category() &&
+           0 != std::count(retryableErrors.begin(), retryableErrors.end(),
+                           ec.value());
+}
+
+/** @brief Whether an error from the filesystem means the device is gone. */
+static bool gone(const std::error_code& ec, bool nodev)
+{
+    return ec.category() == std::generic_category() &&
+           (ec.value() == ENOENT || (nodev && ec.value() == ENODEV));
+}
+
+ReadResult HwmonIOInterface::tryRead(const std::string& type,
+                                     const std::string& id,
+                                     const std::string& sensor, size_t retries,
+                                     std::chrono::milliseconds delay) const
+{
+    try
+    {
+        return read(type, id, sensor, retries, delay);
+    }
+    catch (const std::system_error& e)
+    {
+        return std::unexpected(e.code());
+    }
+}
+
+WriteResult HwmonIOInterface::tryWrite(
+    uint32_t val, const std::string& type, const std::string& id,
+    const std::string& sensor, size_t retries,
+    std::chrono::milliseconds delay) const
+{
+    try
+    {
+        write(val, type, id, sensor, retries, delay);
+        return {};
+    }
+    catch (const std::system_error& e)
+    {
+        return std::unexpected(e.code());
+    }
+}
+
 HwmonIO::HwmonIO(const std::string& path, const FileSystemInterface* intf) :
     _p(path), _intf(intf)
 {}
@@ -121,113 +322,248 @@ int64_t HwmonIO::read(const std::string& type, const std::string& id,
                       const std::string& sensor, size_t retries,
                       std::chrono::milliseconds delay) const
 {
-    int64_t val;
-    auto fullPath = sysfs::make_sysfs_path(_p, type, id, sensor);
-
-    while (true)
+    auto val = tryRead(type, id, sensor, retries, delay);
+    if (!val)
     {
-        try
+#if NEGATIVE_ERRNO_ON_FAIL
+        if (val.error().category() == std::generic_category())
         {
-            val = _intf->read(fullPath);
+            return -val.error().value();
         }
-        catch (const std::exception& e)
-        {
-            auto rc = errno;
+#endif
 
-            if (!rc)
-            {
-                throw;
-            }
+        // Work around GCC bugs 53984 and 66145 for callers by
+        // explicitly raising system_error here.
+        throw std::system_error(val.error());
+    }
 
-            if (rc == ENOENT || rc == ENODEV)
-            {
-                // If the directory or device disappeared then this application
-                // should gracefully exit.  There are race conditions between
-                // the unloading of a hwmon driver and the stopping of this
-                // service by systemd.  To prevent this application from falsely
-                // failing in these scenarios, it will simply exit if the
-                // directory or file can not be found.  It is up to the user(s)
-                // of this provided hwmon object to log the appropriate errors
-                // if the object disappears when it should not.
-                exit(0);
-            }
+    return *val;
+}
 
-            if (0 == std::count(retryableErrors.begin(), retryableErrors.end(),
-                                rc) ||
-                !retries)
-            {
-                // Not a retryable error or out of retries.
-#if NEGATIVE_ERRNO_ON_FAIL
-                return -rc;
-#endif
+ReadResult HwmonIO::tryRead(const std::string& type, const std::string& id,
+                            const std::string& sensor, size_t retries,
+                            std::chrono::milliseconds delay) const
+{
+    auto fullPath = sysfs::make_sysfs_path(_p, type, id, sensor);
 
-                // Work around GCC bugs 53984 and 66145 for callers by
-                // explicitly raising system_error here.
-                throw std::system_error(rc, std::generic_category());
-            }
+    while (true)
+    {
+        auto val = _intf->tryRead(fullPath);
+        if (val)
+        {
+            return val;
+        }
 
-            --retries;
-            std::this_thread::sleep_for(delay);
-            continue;
+        if (exitWhenGone && gone(val.error(), true))
+        {
+            // If the directory or device disappeared then this application
+            // should gracefully exit.  There are race conditions between
+            // the unloading of a hwmon driver and the stopping of this
+            // service by systemd.  To prevent this application from falsely
+            // failing in these scenarios, it will simply exit if the
+            // directory or file can not be found.  It is up to the user(s)
+            // of this provided hwmon object to log the appropriate errors
+            // if the object disappears when it should not.
+            exit(0);
         }
-        break;
-    }
 
-    return val;
+        if (!retryable(val.error()) || !retries)
+        {
+            // Not a retryable error or out of retries.
+            return val;
+        }
+
+        --retries;
+        ++retried;
+        std::this_thread::sleep_for(delay);
+    }
 }
 
 void HwmonIO::write(uint32_t val, const std::string& type,
                     const std::string& id, const std::string& sensor,
                     size_t retries, std::chrono::milliseconds delay) const
+{
+    auto result = tryWrite(val, type, id, sensor, retries, delay);
+    if (!result)
+    {
+        // Work around GCC bugs 53984 and 66145 for callers by
+        // explicitly raising system_error here.
+        throw std::system_error(result.error());
+    }
+}
 
+WriteResult HwmonIO::tryWrite(uint32_t val, const std::string& type,
+                              const std::string& id, const std::string& sensor,
+                              size_t retries,
+                              std::chrono::milliseconds delay) const
 {
     auto fullPath = sysfs::make_sysfs_path(_p, type, id, sensor);
 
-    // See comments in the read method for an explanation of the odd exception
-    // handling behavior here.
-
+    // See comments in the tryRead method for an explanation of the error
+    // handling here.
     while (true)
     {
-        try
+        auto result = _intf->tryWrite(fullPath, val);
+        if (result)
         {
-            _intf->write(fullPath, val);
+            return result;
         }
-        catch (const std::exception& e)
+
+        if (exitWhenGone && gone(result.error(), false))
         {
-            auto rc = errno;
+            exit(0);
+        }
 
-            if (!rc)
-            {
-                throw;
-            }
+        if (!retryable(result.error()) || !retries)
+        {
+            return result;
+        }
 
-            if (rc == ENOENT)
-            {
-                exit(0);
-            }
+        --retries;
+        ++retried;
+        std::this_thread::sleep_for(delay);
+    }
+}
 
-            if (0 == std::count(retryableErrors.begin(), retryableErrors.end(),
-                                rc) ||
-                !retries)
-            {
-                // Not a retryable error or out of retries.
+std::string HwmonIO::path() const
+{
+    return _p;
+}
 
-                // Work around GCC bugs 53984 and 66145 for callers by
-                // explicitly raising system_error here.
-                throw std::system_error(rc, std::generic_category());
+Attribute::Attribute(const std::string& path) : _path(path)
+{
+    _fd = ::open(_path.c_str(), O_RDWR | O_CLOEXEC);
+    if (_fd < 0)
+    {
+        // Attributes without a store method, such as inputs, can only
+        // be opened for reading.
+        _fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+
+    if (_fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), _path);
+    }
+}
+
+Attribute::Attribute(Attribute&& other) noexcept :
+    _path(std::move(other._path)), _fd(std::exchange(other._fd, -1))
+{}
+
+Attribute& Attribute::operator=(Attribute&& other) noexcept
+{
+    if (this != &other)
+    {
+        std::swap(_path, other._path);
+        std::swap(_fd, other._fd);
+    }
+    return *this;
+}
+
+Attribute::~Attribute()
+{
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+    }
+}
+
+int64_t Attribute::read(size_t retries, std::chrono::milliseconds delay) const
+{
+    auto val = tryRead(retries, delay);
+    if (!val)
+    {
+#if NEGATIVE_ERRNO_ON_FAIL
+        if (val.error().category() == std::generic_category())
+        {
+            return -val.error().value();
+        }
+#endif
+        throw std::system_error(val.error());
+    }
+    return *val;
+}
+
+ReadResult Attribute::tryRead(size_t retries,
+                              std::chrono::milliseconds delay) const
+{
+    std::array<char, 32> buf;
+
+    // See comments in HwmonIO::tryRead for an explanation of the error
+    // handling here.
+    while (true)
+    {
+        // sysfs regenerates the attribute content on every read from
+        // offset zero, so there is no need to reopen or seek.
+        auto n = ::pread(_fd, buf.data(), buf.size(), 0);
+        if (n >= 0)
+        {
+            auto begin = std::find_if_not(
+                buf.data(), buf.data() + n, [](char c) {
+                    return std::isspace(static_cast<unsigned char>(c));
+                });
+            int64_t val;
+            auto [ptr, ec] = std::from_chars(begin, buf.data() + n, val);
+            if (ec != std::errc())
+            {
+                // Not a number, as FileSystem::tryRead reports it.
+                return std::unexpected(
+                    std::make_error_code(std::io_errc::stream));
             }
+            return val;
+        }
 
-            --retries;
-            std::this_thread::sleep_for(delay);
-            continue;
+        auto rc = errno;
+        if (exitWhenGone && (rc == ENOENT || rc == ENODEV))
+        {
+            exit(0);
         }
-        break;
+
+        if (0 == std::count(retryableErrors.begin(), retryableErrors.end(),
+                            rc) ||
+            !retries)
+        {
+            return std::unexpected(
+                std::error_code(rc, std::generic_category()));
+        }
+
+        --retries;
+        ++retried;
+        std::this_thread::sleep_for(delay);
     }
 }
 
-std::string HwmonIO::path() const
+void Attribute::write(uint64_t val, size_t retries,
+                      std::chrono::milliseconds delay) const
 {
-    return _p;
+    std::array<char, 24> buf;
+    auto end = std::to_chars(buf.data(), buf.data() + buf.size(), val).ptr;
+    auto len = end - buf.data();
+
+    while (true)
+    {
+        if (::pwrite(_fd, buf.data(), len, 0) >= 0)
+        {
+            return;
+        }
+
+        auto rc = errno;
+        if (exitWhenGone && rc == ENOENT)
+        {
+            exit(0);
+        }
+
+        if (0 == std::count(retryableErrors.begin(), retryableErrors.end(),
+                            rc) ||
+            !retries)
+        {
+            throw std::system_error(rc, std::generic_category());
+        }
+
+        --retries;
+        ++retried;
+        std::this_thread::sleep_for(delay);
+    }
 }
 
 } // namespace hwmonio
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <expected>
+#include <optional>
 #include <string>
+#include <system_error>
 
 namespace hwmonio
 {
@@ -9,10 +13,20 @@ namespace hwmonio
 static constexpr auto retries = 10;
 static constexpr auto delay = std::chrono::milliseconds{100};
 
+/** @brief The result of a read, the value or why it failed. */
+using ReadResult = std::expected<int64_t, std::error_code>;
+/** @brief The result of a write, nothing or why it failed. */
+using WriteResult = std::expected<void, std::error_code>;
+
 /** @class FileSystemInterface
  *  @brief Abstract base class allowing testing of HwmonIO.
  *
  *  This is used to provide testing of behaviors within HwmonIO.
+ *
+ *  read() and write() throw on failure, with errno set if the failure
+ *  came from the filesystem.  tryRead() and tryWrite() return the error
+ *  instead, implementations can override them to avoid the cost of the
+ *  exception.
  */
 class FileSystemInterface
 {
@@ -20,6 +34,30 @@ class FileSystemInterface
     virtual ~FileSystemInterface() = default;
     virtual int64_t read(const std::string& path) const = 0;
     virtual void write(const std::string& path, uint32_t value) const = 0;
+
+    /** @brief Read a value without throwing.
+     *
+     *  By default calls read(), failures that don't set errno are still
+     *  thrown.
+     *
+     *  @param[in] path - The file to read.
+     *
+     *  @return - The value, or the errno the read failed with.
+     */
+    virtual ReadResult tryRead(const std::string& path) const;
+
+    /** @brief Write a value without throwing.
+     *
+     *  By default calls write(), failures that don't set errno are still
+     *  thrown.
+     *
+     *  @param[in] path - The file to write.
+     *  @param[in] value - The value to write.
+     *
+     *  @return - Nothing, or the errno the write failed with.
+     */
+    virtual WriteResult tryWrite(const std::string& path,
+                                 uint32_t value) const;
 };
 
 class FileSystem : public FileSystemInterface
@@ -27,10 +65,70 @@ class FileSystem : public FileSystemInterface
   public:
     int64_t read(const std::string& path) const override;
     void write(const std::string& path, uint32_t value) const override;
+    ReadResult tryRead(const std::string& path) const override;
+    WriteResult tryWrite(const std::string& path,
+                         uint32_t value) const override;
 };
 
 extern FileSystem fileSystemImpl;
 
+/** @brief The chip attribute holding its conversion interval. */
+static constexpr auto updateInterval = "update_interval";
+
+/** @brief Read an hwmon instance's update_interval.
+ *
+ *  Drivers that cache register values refresh them every update_interval
+ *  milliseconds, reading more often only returns the cached values.
+ *
+ *  @param[in] path - hwmon instance root - eg: /sys/class/hwmon/hwmon<N>
+ *  @param[in] intf - Filesystem access.
+ *
+ *  @return - The interval, std::nullopt if the instance has none.
+ */
+std::optional<std::chrono::milliseconds> readUpdateInterval(
+    const std::string& path, const FileSystemInterface* intf = &fileSystemImpl);
+
+/** @brief Set an hwmon instance's update_interval.
+ *
+ *  The driver may round the interval to one the chip supports, read it
+ *  back to find out what was set.
+ *
+ *  @param[in] path - hwmon instance root - eg: /sys/class/hwmon/hwmon<N>
+ *  @param[in] interval - The interval to set.
+ *  @param[in] intf - Filesystem access.
+ *
+ *  @return - Whether the interval was written.
+ */
+bool writeUpdateInterval(const std::string& path,
+                         std::chrono::milliseconds interval,
+                         const FileSystemInterface* intf = &fileSystemImpl);
+
+/** @brief Get the number of reads and writes retried since startup.
+ *
+ *  Retries are counted whether or not the access finally succeeded, so an
+ *  increase shows a device struggling to keep up.
+ *
+ *  @return - The number of retries.
+ */
+uint64_t retryCount();
+
+/** @brief Set whether to exit when the device goes away.
+ *
+ *  By default a read or write that finds the device gone, with ENOENT or
+ *  ENODEV, exits the process.  When disabled the error is returned or
+ *  thrown like any other, for callers that wait for the device to come
+ *  back.
+ *
+ *  @param[in] exit - Whether to exit.
+ */
+void exitOnRemoval(bool exit);
+
+/** @brief Get whether to exit when the device goes away.
+ *
+ *  @return - Whether to exit, see exitOnRemoval(bool).
+ */
+bool exitOnRemoval();
+
 /** @class HwmonIOInterface
  *  @brief Abstract base class defining a HwmonIOInterface.
  *
@@ -52,6 +150,25 @@ class HwmonIOInterface
                        std::chrono::milliseconds delay) const = 0;
 
     virtual std::string path() const = 0;
+
+    /** @brief Read without throwing std::system_error.
+     *
+     *  By default calls read() and returns the code of any
+     *  std::system_error thrown.
+     */
+    virtual ReadResult tryRead(const std::string& type, const std::string& id,
+                               const std::string& sensor, size_t retries,
+                               std::chrono::milliseconds delay) const;
+
+    /** @brief Write without throwing std::system_error.
+     *
+     *  By default calls write() and returns the code of any
+     *  std::system_error thrown.
+     */
+    virtual WriteResult tryWrite(uint32_t val, const std::string& type,
+                                 const std::string& id,
+                                 const std::string& sensor, size_t retries,
+                                 std::chrono::milliseconds delay) const;
 };
 
 /** @class HwmonIO
@@ -103,6 +220,17 @@ class HwmonIO : public HwmonIOInterface
                  const std::string& sensor, size_t retries,
                  std::chrono::milliseconds delay) const override;
 
+    /** @brief Perform formatted hwmon sysfs read without throwing.
+     *
+     *  As read(), but errors are returned rather than thrown, so a
+     *  failing device doesn't cost an exception on every read.
+     *
+     *  @return - The read value, or the error once out of retries.
+     */
+    ReadResult tryRead(const std::string& type, const std::string& id,
+                       const std::string& sensor, size_t retries,
+                       std::chrono::milliseconds delay) const override;
+
     /** @brief Perform formatted hwmon sysfs write.
      *
      *  Propagates any exceptions other than ENOENT.
@@ -123,6 +251,17 @@ class HwmonIO : public HwmonIOInterface
                const std::string& sensor, size_t retries,
                std::chrono::milliseconds delay) const override;
 
+    /** @brief Perform formatted hwmon sysfs write without throwing.
+     *
+     *  As write(), but errors are returned rather than thrown.
+     *
+     *  @return - Nothing, or the error once out of retries.
+     */
+    WriteResult tryWrite(uint32_t val, const std::string& type,
+                         const std::string& id, const std::string& sensor,
+                         size_t retries,
+                         std::chrono::milliseconds delay) const override;
+
     /** @brief Hwmon instance path access.
      *
      *  @return path - The hwmon instance path.
@@ -134,4 +273,83 @@ class HwmonIO : public HwmonIOInterface
     const FileSystemInterface* _intf;
 };
 
+/** @class Attribute
+ *  @brief An hwmon sysfs attribute that is kept open.
+ *
+ *  Reads and writes go straight to the open file descriptor through
+ *  fixed size buffers, so once constructed no heap allocations are made
+ *  on the success path.  Used where IO latency matters, such as fan
+ *  targets and tach reads in real-time mode.
+ *
+ *  Error handling matches HwmonIO: ENOENT and ENODEV exit(0), retryable
+ *  errors are retried and anything else is thrown as std::system_error.
+ */
+class Attribute
+{
+  public:
+    Attribute() = delete;
+    Attribute(const Attribute&) = delete;
+    Attribute& operator=(const Attribute&) = delete;
+    Attribute(Attribute&& other) noexcept;
+    Attribute& operator=(Attribute&& other) noexcept;
+    ~Attribute();
+
+    /** @brief Constructor
+     *
+     *  Throws std::system_error if the attribute can't be opened.
+     *
+     *  @param[in] path - Full path of the sysfs attribute.
+     */
+    explicit Attribute(const std::string& path);
+
+    /** @brief Read the attribute.
+     *
+     *  @param[in] retries - The number of times to retry.
+     *  @param[in] delay - The time to sleep between retry attempts.
+     *
+     *  @return val - The read value.
+     */
+    int64_t read(size_t retries, std::chrono::milliseconds delay) const;
+
+    /** @brief Read the attribute without throwing.
+     *
+     *  @param[in] retries - The number of times to retry.
+     *  @param[in] delay - The time to sleep between retry attempts.
+     *
+     *  @return - The read value, or the error once out of retries.
+     */
+    ReadResult tryRead(size_t retries, std::chrono::milliseconds delay) const;
+
+    /** @brief Write the attribute.
+     *
+     *  @param[in] val - The value to be written.
+     *  @param[in] retries - The number of times to retry.
+     *  @param[in] delay - The time to sleep between retry attempts.
+     */
+    void write(uint64_t val, size_t retries,
+               std::chrono::milliseconds delay) const;
+
+    /** @brief Attribute path access.
+     *
+     *  @return path - The sysfs attribute path.
+     */
+    const std::string& path() const
+    {
+        return _path;
+    }
+
+    /** @brief File descriptor access, for polling the attribute.
+     *
+     *  @return fd - The open file descriptor.
+     */
+    int fd() const
+    {
+        return _fd;
+    }
+
+  private:
+    std::string _path;
+    int _fd = -1;
+};
+
 } // namespace hwmonio
@@ -0,0 +1,218 @@
+#include "iio.hpp"
+
+#include "hwmon.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <regex>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace iio
+{
+
+/** @brief IIO channel types read, with the matching hwmon type.
+ *
+ *  Only types whose IIO units, after scaling, match the hwmon ones.
+ */
+static constexpr std::pair<const char*, const char*> channelTypes[] = {
+    {"in", "voltage"},
+    {"curr", "current"},
+    {"temp", "temp"},
+};
+
+static std::optional<double> readDouble(const std::string& path)
+{
+    std::ifstream ifs(path);
+    double value;
+    if (ifs >> value)
+    {
+        return value;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> channelName(const SensorSet::key_type& sensor)
+{
+    for (const auto& [hwmon, iio] : channelTypes)
+    {
+        if (sensor.first == hwmon)
+        {
+            return std::string("in_") + iio + sensor.second;
+        }
+    }
+    return std::nullopt;
+}
+
+Calibration readCalibration(const std::string& devicePath,
+                            const SensorSet::key_type& sensor)
+{
+    Calibration cal;
+    auto channel = channelName(sensor);
+    if (!channel)
+    {
+        return cal;
+    }
+
+    // The type prefix, ex. in_voltage for in_voltage3.
+    auto type = channel->substr(0, channel->size() - sensor.second.size());
+    auto attr = [&](const std::string& name) {
+        auto value = readDouble(devicePath + '/' + *channel + '_' + name);
+        if (!value)
+        {
+            value = readDouble(devicePath + '/' + type + '_' + name);
+        }
+        return value;
+    };
+
+    cal.scale = attr("scale").value_or(cal.scale);
+    cal.offset = attr("offset").value_or(cal.offset);
+
+    return cal;
+}
+
+bool isDevice(const std::string& path)
+{
+    auto name = fs::path(path).filename().string();
+    if (name.empty())
+    {
+        name = fs::path(path).parent_path().filename().string();
+    }
+    return name.starts_with("iio:device");
+}
+
+std::string findDeviceFromDevPath(const std::string& devPath)
+{
+    fs::path p{"/sys"};
+    p /= fs::path(devPath).relative_path();
+
+    // See findHwmonFromDevPath, ':'s are passed in as '--'s.
+    std::string path = p;
+    size_t pos = 0;
+    while ((pos = path.find("--")) != std::string::npos)
+    {
+        path.replace(pos, 2, ":");
+    }
+
+    std::error_code ec;
+    if (!isDevice(path) || !fs::is_directory(path, ec))
+    {
+        return {};
+    }
+
+    return path;
+}
+
+std::string findCalloutPath(const std::string& devicePath)
+{
+    std::error_code ec;
+    auto path = fs::canonical(devicePath, ec);
+    if (ec)
+    {
+        return {};
+    }
+
+    // The IIO device is a child of the physical device.
+    return path.parent_path();
+}
+
+SensorSet::container_t findSensors(const std::string& devicePath)
+{
+    static const std::regex raw{"^in_([a-z]+)([0-9]+)_raw$"};
+
+    SensorSet::container_t sensors;
+    std::error_code ec;
+    for (const auto& file : fs::directory_iterator(devicePath, ec))
+    {
+        std::smatch match;
+        auto name = file.path().filename().string();
+        if (!std::regex_match(name, match, raw))
+        {
+            continue;
+        }
+
+        for (const auto& [hwmon, iio] : channelTypes)
+        {
+            if (match[1] == iio)
+            {
+                sensors[std::make_pair(hwmon, match[2])].emplace(
+                    hwmon::entry::input);
+            }
+        }
+    }
+
+    return sensors;
+}
+
+IioIO::IioIO(const std::string& path,
+             const hwmonio::FileSystemInterface* intf) : _raw(path, intf)
+{}
+
+int64_t IioIO::read(const std::string& type, const std::string& id,
+                    const std::string& sensor, size_t retries,
+                    std::chrono::milliseconds delay) const
+{
+    auto key = std::make_pair(type, id);
+    auto channel = channelName(key);
+    if (!channel || sensor != hwmon::entry::input)
+    {
+        throw std::system_error(ENOTSUP, std::generic_category());
+    }
+
+    // ex. in_voltage1_raw
+    auto raw = _raw.read(*channel, "", "raw", retries, delay);
+
+    return std::llround(calibration(key).apply(raw));
+}
+
+hwmonio::ReadResult IioIO::tryRead(const std::string& type,
+                                   const std::string& id,
+                                   const std::string& sensor, size_t retries,
+                                   std::chrono::milliseconds delay) const
+{
+    auto key = std::make_pair(type, id);
+    auto channel = channelName(key);
+    if (!channel || sensor != hwmon::entry::input)
+    {
+        return std::unexpected(std::make_error_code(std::errc::not_supported));
+    }
+
+    auto raw = _raw.tryRead(*channel, "", "raw", retries, delay);
+    if (!raw)
+    {
+        return raw;
+    }
+
+    return std::llround(calibration(key).apply(*raw));
+}
+
+void IioIO::write(uint32_t, const std::string&, const std::string&,
+                  const std::string&, size_t, std::chrono::milliseconds) const
+{
+    throw std::system_error(ENOTSUP, std::generic_category());
+}
+
+std::string IioIO::path() const
+{
+    return _raw.path();
+}
+
+Calibration IioIO::calibration(const SensorSet::key_type& sensor) const
+{
+    std::lock_guard lock(_lock);
+
+    auto it = _calibration.find(sensor);
+    if (it == _calibration.end())
+    {
+        it = _calibration.emplace(sensor, readCalibration(path(), sensor))
+                 .first;
+    }
+
+    return it->second;
+}
+
+} // namespace iio
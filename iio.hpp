@@ -0,0 +1,159 @@
+#pragma once
+
+#include "hwmonio.hpp"
+#include "sensorset.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace iio
+{
+
+/** @brief Whether a path is an IIO device (ex. iio:device0).
+ *
+ *  @param[in] path - The sysfs path.
+ */
+bool isDevice(const std::string& path);
+
+/** @brief Find an IIO device from a device path
+ *
+ *  @param[in] devPath - The device path, starting with /devices and with
+ *                       ':'s converted to '--'s.
+ *
+ *  @return - The IIO device path or an empty string if it isn't one.
+ */
+std::string findDeviceFromDevPath(const std::string& devPath);
+
+/** @brief Return the path to use for a call out.
+ *
+ *  @param[in] devicePath - /sys/bus/iio/devices/iio:device<N> path.
+ *
+ *  @return - The physical device the IIO device belongs to, an empty
+ *            string if it can't be found.
+ */
+std::string findCalloutPath(const std::string& devicePath);
+
+/** @brief Find the channels of an IIO device.
+ *
+ *  Channels are presented the way hwmon sensors are, keyed by the hwmon
+ *  type and the channel index, ex. in_voltage3_raw is {"in", "3"} with an
+ *  input attribute.
+ *
+ *  @param[in] devicePath - /sys/bus/iio/devices/iio:device<N> path.
+ *
+ *  @return - The channels found.
+ */
+SensorSet::container_t findSensors(const std::string& devicePath);
+
+/** @brief Get the IIO channel of a sensor.
+ *
+ *  @param[in] sensor - The sensor's identifiers, ex. {"in", "3"}.
+ *
+ *  @return - The channel, ex. in_voltage3, std::nullopt if the sensor
+ *            type has no IIO equivalent.
+ */
+std::optional<std::string> channelName(const SensorSet::key_type& sensor);
+
+/** @brief Conversion from raw channel values to hwmon units. */
+struct Calibration
+{
+    double scale = 1.0;
+    double offset = 0.0;
+
+    /** @brief Convert a raw value. */
+    inline double apply(int64_t raw) const
+    {
+        return (raw + offset) * scale;
+    }
+};
+
+/** @brief Read the scale and offset of a channel.
+ *
+ *  A channel without its own scale or offset uses the one shared by its
+ *  type, ex. in_voltage_scale.
+ *
+ *  @param[in] devicePath - /sys/bus/iio/devices/iio:device<N> path.
+ *  @param[in] sensor - The sensor's identifiers, ex. {"in", "3"}.
+ *
+ *  @return - The calibration, unscaled if the channel has none.
+ */
+Calibration readCalibration(const std::string& devicePath,
+                            const SensorSet::key_type& sensor);
+
+/** @class IioIO
+ *  @brief Reads IIO channels directly, without the iio-hwmon driver.
+ *  @details The raw channel values are converted to hwmon units with the
+ *  channel's scale and offset, which are read once and then cached.  The
+ *  retry and exit on ENOENT behavior is the same as HwmonIO.  Channels
+ *  can't be written.
+ */
+class IioIO : public hwmonio::HwmonIOInterface
+{
+  public:
+    IioIO() = delete;
+    IioIO(const IioIO&) = delete;
+    IioIO(IioIO&&) = delete;
+    IioIO& operator=(const IioIO&) = delete;
+    IioIO& operator=(IioIO&&) = delete;
+    ~IioIO() override = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] path - IIO device root - eg:
+     *      /sys/bus/iio/devices/iio:device<N>
+     *  @param[in] intf - Filesystem access.
+     */
+    explicit IioIO(const std::string& path,
+                   const hwmonio::FileSystemInterface* intf =
+                       &hwmonio::fileSystemImpl);
+
+    /** @brief Read a channel, converted to hwmon units.
+     *
+     *  @param[in] type - The hwmon type (ex. in).
+     *  @param[in] id - The channel index (ex. 1).
+     *  @param[in] sensor - The hwmon sensor, only input is supported.
+     *  @param[in] retries - The number of times to retry.
+     *  @param[in] delay - The time to sleep between retry attempts.
+     *
+     *  @return val - The read value.
+     */
+    int64_t read(const std::string& type, const std::string& id,
+                 const std::string& sensor, size_t retries,
+                 std::chrono::milliseconds delay) const override;
+
+    /** @brief Read a channel without throwing.
+     *
+     *  @return - The value in hwmon units, or the error.
+     */
+    hwmonio::ReadResult tryRead(const std::string& type, const std::string& id,
+                                const std::string& sensor, size_t retries,
+                                std::chrono::milliseconds delay) const override;
+
+    /** @brief Channels can't be written, always throws ENOTSUP. */
+    void write(uint32_t val, const std::string& type, const std::string& id,
+               const std::string& sensor, size_t retries,
+               std::chrono::milliseconds delay) const override;
+
+    /** @brief IIO device path access.
+     *
+     *  @return path - The IIO device path.
+     */
+    std::string path() const override;
+
+  private:
+    /** @brief Get the cached scale and offset of a channel. */
+    Calibration calibration(const SensorSet::key_type& sensor) const;
+
+    /** @brief Raw channel access. */
+    hwmonio::HwmonIO _raw;
+    /** @brief Cached channel calibration, reads may come from async read
+     *         threads. */
+    mutable std::mutex _lock;
+    mutable std::map<SensorSet::key_type, Calibration> _calibration;
+};
+
+} // namespace iio
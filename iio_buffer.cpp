@@ -0,0 +1,436 @@
+#include "iio_buffer.hpp"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace iio
+{
+
+static void writeAttr(const std::string& path, const std::string& value)
+{
+    errno = 0;
+    std::ofstream ofs(path);
+    ofs << value;
+    ofs.flush();
+    if (!ofs)
+    {
+        throw std::system_error(errno ? errno : EIO, std::generic_category(),
+                                path);
+    }
+}
+
+static std::string readAttr(const std::string& path)
+{
+    errno = 0;
+    std::ifstream ifs(path);
+    std::string value;
+    if (!(ifs >> value))
+    {
+        throw std::system_error(errno ? errno : EIO, std::generic_category(),
+                                path);
+    }
+    return value;
+}
+
+std::optional<ScanType> ScanType::parse(const std::string& type)
+{
+    static const std::regex format{
+        "^(be|le):([su])([0-9]+)/([0-9]+)(?:X([0-9]+))?>>([0-9]+)$"};
+
+    std::smatch match;
+    if (!std::regex_match(type, match, format))
+    {
+        return std::nullopt;
+    }
+
+    ScanType scan;
+    scan.bigEndian = match[1] == "be";
+    scan.isSigned = match[2] == "s";
+    scan.realBits = std::stoul(match[3]);
+    scan.storageBits = std::stoul(match[4]);
+    scan.shift = std::stoul(match[6]);
+    if (match[5].matched)
+    {
+        scan.repeat = std::stoul(match[5]);
+    }
+
+    if (scan.storageBits == 0 || scan.storageBits > 64 ||
+        scan.storageBits % 8 != 0 || scan.realBits == 0 ||
+        scan.realBits + scan.shift > scan.storageBits || scan.repeat == 0)
+    {
+        return std::nullopt;
+    }
+
+    return scan;
+}
+
+int64_t ScanType::decode(const uint8_t* data) const
+{
+    uint64_t value = 0;
+    auto n = bytes();
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto byte = bigEndian ? data[i] : data[n - 1 - i];
+        value = (value << 8) | byte;
+    }
+
+    value >>= shift;
+    if (realBits < 64)
+    {
+        value &= (uint64_t{1} << realBits) - 1;
+        if (isSigned && (value & (uint64_t{1} << (realBits - 1))))
+        {
+            // Sign extend.
+            value |= ~((uint64_t{1} << realBits) - 1);
+        }
+    }
+
+    return static_cast<int64_t>(value);
+}
+
+ScanLayout::ScanLayout(const std::vector<ScanType>& types) : _types(types)
+{
+    size_t align = 1;
+    for (const auto& type : _types)
+    {
+        // As the kernel lays out scans, a channel with repeats is aligned
+        // to the size of all of its samples.
+        auto bytes = type.size();
+        if (_size % bytes)
+        {
+            _size += bytes - _size % bytes;
+        }
+        _offsets.push_back(_size);
+        _size += bytes;
+        align = std::max(align, bytes);
+    }
+
+    if (_size % align)
+    {
+        _size += align - _size % align;
+    }
+}
+
+RawRing::RawRing(const std::string& name, size_t capacity, size_t scanSize) :
+    _name(name), _length(sizeof(Header) + capacity)
+{
+    auto fd = ::shm_open(_name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), _name);
+    }
+
+    void* addr = MAP_FAILED;
+    if (::ftruncate(fd, _length) == 0)
+    {
+        addr = ::mmap(nullptr, _length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd, 0);
+    }
+    auto rc = errno;
+    ::close(fd);
+
+    if (addr == MAP_FAILED)
+    {
+        ::shm_unlink(_name.c_str());
+        throw std::system_error(rc, std::generic_category(), _name);
+    }
+
+    _header = static_cast<Header*>(addr);
+    _data = static_cast<uint8_t*>(addr) + sizeof(Header);
+    _header->capacity = capacity;
+    _header->scanSize = scanSize;
+    __atomic_store_n(&_header->head, 0, __ATOMIC_RELEASE);
+}
+
+RawRing::~RawRing()
+{
+    ::munmap(_header, _length);
+    ::shm_unlink(_name.c_str());
+}
+
+void RawRing::write(const uint8_t* data, size_t size)
+{
+    auto capacity = _header->capacity;
+    auto head = __atomic_load_n(&_header->head, __ATOMIC_RELAXED);
+    auto written = size;
+
+    // Only the newest capacity bytes fit.
+    if (size > capacity)
+    {
+        data += size - capacity;
+        head += size - capacity;
+        size = capacity;
+    }
+
+    auto at = head % capacity;
+    auto first = std::min(size, capacity - at);
+    std::memcpy(_data + at, data, first);
+    std::memcpy(_data, data + first, size - first);
+
+    __atomic_store_n(&_header->head,
+                     __atomic_load_n(&_header->head, __ATOMIC_RELAXED) +
+                         written,
+                     __ATOMIC_RELEASE);
+}
+
+BufferStream::BufferStream(const sdeventplus::Event& event,
+                           const std::string& devicePath,
+                           const std::string& node,
+                           const std::vector<SensorSet::key_type>& sensors,
+                           size_t length, const std::string& trigger,
+                           const std::string& ring) : _devicePath(devicePath)
+{
+    // The buffer would be read into an empty block, and never drained.
+    if (length == 0)
+    {
+        throw std::system_error(EINVAL, std::generic_category(),
+                                "Zero length IIO buffer");
+    }
+
+    auto scan = _devicePath + "/scan_elements/";
+
+    writeAttr(_devicePath + "/buffer/enable", "0");
+
+    try
+    {
+        // Only the streamed channels may be in the scans.
+        for (const auto& file : fs::directory_iterator(scan))
+        {
+            if (file.path().filename().string().ends_with("_en"))
+            {
+                writeAttr(file.path(), "0");
+            }
+        }
+
+        struct Element
+        {
+            unsigned long index;
+            SensorSet::key_type sensor;
+            std::string channel;
+            ScanType type;
+        };
+        std::vector<Element> elements;
+
+        for (const auto& sensor : sensors)
+        {
+            auto channel = channelName(sensor);
+            std::error_code ec;
+            if (!channel || !fs::exists(scan + *channel + "_en", ec))
+            {
+                continue;
+            }
+
+            auto type = ScanType::parse(readAttr(scan + *channel + "_type"));
+            if (!type)
+            {
+                continue;
+            }
+
+            elements.push_back(
+                {std::stoul(readAttr(scan + *channel + "_index")), sensor,
+                 *channel, *type});
+        }
+
+        if (elements.empty())
+        {
+            throw std::system_error(ENOTSUP, std::generic_category(),
+                                    "No channels to stream");
+        }
+
+        std::sort(elements.begin(), elements.end(),
+                  [](const auto& a, const auto& b) {
+                      return a.index < b.index;
+                  });
+
+        std::vector<ScanType> types;
+        for (const auto& element : elements)
+        {
+            writeAttr(scan + element.channel + "_en", "1");
+            _channels.emplace(element.sensor,
+                              Channel{types.size(),
+                                      readCalibration(_devicePath,
+                                                      element.sensor),
+                                      {}});
+            types.push_back(element.type);
+        }
+        _layout.emplace(types);
+
+        if (!trigger.empty())
+        {
+            writeAttr(_devicePath + "/trigger/current_trigger", trigger);
+        }
+        writeAttr(_devicePath + "/buffer/length", std::to_string(length));
+        writeAttr(_devicePath + "/buffer/enable", "1");
+
+        _block.resize(length * _layout->size());
+        if (!ring.empty())
+        {
+            // Room for a few buffers worth of scans.
+            _ring = std::make_unique<RawRing>(ring, _block.size() * 4,
+                                              _layout->size());
+        }
+
+        _fd = ::open(node.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (_fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), node);
+        }
+
+        _source.emplace(event, _fd, EPOLLIN,
+                        [this](auto&, int, uint32_t) { readable(); });
+    }
+    catch (...)
+    {
+        if (_fd >= 0)
+        {
+            ::close(_fd);
+        }
+        disable();
+        throw;
+    }
+}
+
+BufferStream::~BufferStream()
+{
+    _source.reset();
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+    }
+    disable();
+}
+
+std::string BufferStream::node(const std::string& devicePath)
+{
+    return "/dev/" + fs::path(devicePath).filename().string();
+}
+
+bool BufferStream::streams(const SensorSet::key_type& sensor) const
+{
+    return !_failed && _channels.find(sensor) != _channels.end();
+}
+
+void BufferStream::quiesce(bool quiesced)
+{
+    if (_failed)
+    {
+        return;
+    }
+
+    if (quiesced)
+    {
+        _source->set_enabled(sdeventplus::source::Enabled::Off);
+        disable();
+        return;
+    }
+
+    try
+    {
+        writeAttr(_devicePath + "/buffer/enable", "1");
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("IIO buffer not restarted, stopped streaming: {ERROR}",
+                   "ERROR", e.what());
+        _failed = true;
+        return;
+    }
+    _source->set_enabled(sdeventplus::source::Enabled::On);
+}
+
+std::optional<Summary> BufferStream::take(const SensorSet::key_type& sensor)
+{
+    auto it = _channels.find(sensor);
+    if (it == _channels.end() || it->second.summary.count == 0)
+    {
+        return std::nullopt;
+    }
+
+    return std::exchange(it->second.summary, Summary{});
+}
+
+void BufferStream::consume(const uint8_t* data, size_t size)
+{
+    auto scanSize = _layout->size();
+    for (auto scan = data; scan + scanSize <= data + size; scan += scanSize)
+    {
+        for (auto& [sensor, channel] : _channels)
+        {
+            channel.summary.add(channel.calibration.apply(
+                _layout->decode(scan, channel.position)));
+        }
+    }
+}
+
+void BufferStream::readable()
+{
+    while (true)
+    {
+        auto n = ::read(_fd, _block.data(), _block.size());
+        if (n > 0)
+        {
+            // Reads return whole scans.
+            auto size = n - n % _layout->size();
+            consume(_block.data(), size);
+            if (_ring)
+            {
+                _ring->write(_block.data(), size);
+            }
+            continue;
+        }
+
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n == 0)
+        {
+            // The device went away, stop watching a node that would keep
+            // reporting the hangup.
+            lg2::error("IIO buffer closed, stopped streaming");
+            fail();
+        }
+        else if (errno != EAGAIN)
+        {
+            lg2::error("IIO buffer read failed, stopped streaming: {ERRNO}",
+                       "ERRNO", errno);
+            fail();
+        }
+        return;
+    }
+}
+
+void BufferStream::fail()
+{
+    // Go back to polling the channels through sysfs.
+    _failed = true;
+    _source->set_enabled(sdeventplus::source::Enabled::Off);
+    disable();
+}
+
+void BufferStream::disable() noexcept
+{
+    try
+    {
+        writeAttr(_devicePath + "/buffer/enable", "0");
+    }
+    catch (const std::exception&)
+    {}
+}
+
+} // namespace iio
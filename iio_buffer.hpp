@@ -0,0 +1,284 @@
+#pragma once
+
+#include "iio.hpp"
+#include "sensorset.hpp"
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace iio
+{
+
+/** @struct ScanType
+ *  @brief How a channel's samples are stored in the buffer.
+ *  @details Parsed from the channel's scan_elements/<channel>_type, ex.
+ *  le:s12/16>>4 is a little endian signed 12 bit value stored in 16 bits
+ *  and shifted left by 4.  A channel with X<repeat> after the storage
+ *  bits, ex. le:u24/32X2>>0, has that many samples in each scan.
+ */
+struct ScanType
+{
+    bool bigEndian = false;
+    bool isSigned = false;
+    unsigned realBits = 0;
+    unsigned storageBits = 0;
+    unsigned shift = 0;
+    unsigned repeat = 1;
+
+    /** @brief Parse a scan element type.
+     *
+     *  @param[in] type - The type, ex. le:s12/16>>4.
+     *
+     *  @return - The type, std::nullopt if it isn't valid.
+     */
+    static std::optional<ScanType> parse(const std::string& type);
+
+    /** @brief Bytes taken by one sample. */
+    inline size_t bytes() const
+    {
+        return storageBits / 8;
+    }
+
+    /** @brief Bytes taken by the channel in a scan, all of its samples. */
+    inline size_t size() const
+    {
+        return bytes() * repeat;
+    }
+
+    /** @brief Decode one sample.
+     *
+     *  @param[in] data - The sample's bytes().
+     *
+     *  @return - The raw sample value.
+     */
+    int64_t decode(const uint8_t* data) const;
+};
+
+/** @class ScanLayout
+ *  @brief Where each channel's sample lies within a scan.
+ *  @details A scan holds the samples of every enabled channel in index
+ *  order, each channel aligned to its own size, and is padded to the
+ *  alignment of its largest channel.  Only the first sample of a channel
+ *  with repeats is decoded.
+ */
+class ScanLayout
+{
+  public:
+    /** @brief Constructor
+     *
+     *  @param[in] types - The type of each enabled channel, in index
+     *                     order.
+     */
+    explicit ScanLayout(const std::vector<ScanType>& types);
+
+    /** @brief Bytes taken by one scan. */
+    inline size_t size() const
+    {
+        return _size;
+    }
+
+    /** @brief Decode a channel's sample from a scan.
+     *
+     *  @param[in] scan - The scan's size() bytes.
+     *  @param[in] channel - The position of the channel in the layout.
+     *
+     *  @return - The raw sample value.
+     */
+    inline int64_t decode(const uint8_t* scan, size_t channel) const
+    {
+        return _types[channel].decode(scan + _offsets[channel]);
+    }
+
+  private:
+    std::vector<ScanType> _types;
+    std::vector<size_t> _offsets;
+    size_t _size = 0;
+};
+
+/** @brief The samples of a channel over a publish interval. */
+struct Summary
+{
+    double min = std::numeric_limits<double>::max();
+    double max = std::numeric_limits<double>::lowest();
+    double sum = 0;
+    size_t count = 0;
+
+    /** @brief Add a sample. */
+    inline void add(double value)
+    {
+        min = std::min(min, value);
+        max = std::max(max, value);
+        sum += value;
+        ++count;
+    }
+
+    /** @brief Mean of the samples. */
+    inline double mean() const
+    {
+        return count ? sum / count : 0;
+    }
+};
+
+/** @class RawRing
+ *  @brief Shared memory ring the raw buffer blocks are copied into.
+ *  @details The segment starts with a Header followed by the ring data.
+ *  Readers keep their own read position and compare it against head,
+ *  the total number of bytes ever written, to detect being overrun.
+ */
+class RawRing
+{
+  public:
+    struct Header
+    {
+        /** @brief Bytes of ring data following the header. */
+        uint64_t capacity;
+        /** @brief Bytes ever written, the next write is at head % capacity.
+         */
+        uint64_t head;
+        /** @brief Bytes taken by one scan. */
+        uint32_t scanSize;
+    };
+
+    RawRing() = delete;
+    RawRing(const RawRing&) = delete;
+    RawRing& operator=(const RawRing&) = delete;
+    RawRing(RawRing&&) = delete;
+    RawRing& operator=(RawRing&&) = delete;
+    ~RawRing();
+
+    /** @brief Constructor
+     *
+     *  Throws std::system_error if the segment can't be created.
+     *
+     *  @param[in] name - Shared memory object name, ex. /hwmon-adc0.
+     *  @param[in] capacity - Bytes of ring data.
+     *  @param[in] scanSize - Bytes taken by one scan.
+     */
+    RawRing(const std::string& name, size_t capacity, size_t scanSize);
+
+    /** @brief Append a block of scans. */
+    void write(const uint8_t* data, size_t size);
+
+  private:
+    std::string _name;
+    size_t _length;
+    Header* _header;
+    uint8_t* _data;
+};
+
+/** @class BufferStream
+ *  @brief Streams channel samples from an IIO triggered buffer.
+ *  @details The channels' scan elements are enabled and the buffer is
+ *  read from /dev/iio:device<N> in bulk whenever it has data, which keeps
+ *  up with sample rates polling sysfs can't.  Samples are converted to
+ *  hwmon units and summarised per channel until the next publish takes
+ *  the summary.  If the buffer can't be read anymore, or the device goes
+ *  away, the channels are left to be polled.
+ */
+class BufferStream
+{
+  public:
+    BufferStream() = delete;
+    BufferStream(const BufferStream&) = delete;
+    BufferStream& operator=(const BufferStream&) = delete;
+    BufferStream(BufferStream&&) = delete;
+    BufferStream& operator=(BufferStream&&) = delete;
+    ~BufferStream();
+
+    /** @brief Constructor
+     *
+     *  Throws std::system_error if the buffer can't be set up.
+     *
+     *  @param[in] event - The event loop to read the buffer from.
+     *  @param[in] devicePath - /sys/bus/iio/devices/iio:device<N> path.
+     *  @param[in] node - The device node to read the buffer from, see
+     *                    node().
+     *  @param[in] sensors - The sensors to stream, those without a scan
+     *                       element are left to be polled.
+     *  @param[in] length - Buffer length, in scans, at least 1.
+     *  @param[in] trigger - Trigger to sample on, empty to keep the
+     *                       current one.
+     *  @param[in] ring - Shared memory ring for the raw blocks, empty for
+     *                    none.
+     */
+    BufferStream(const sdeventplus::Event& event,
+                 const std::string& devicePath, const std::string& node,
+                 const std::vector<SensorSet::key_type>& sensors,
+                 size_t length, const std::string& trigger,
+                 const std::string& ring);
+
+    /** @brief Get the device node of an IIO device.
+     *
+     *  @param[in] devicePath - /sys/bus/iio/devices/iio:device<N> path.
+     *
+     *  @return - The node, /dev/iio:device<N>.
+     */
+    static std::string node(const std::string& devicePath);
+
+    /** @brief Whether a sensor's samples are streamed.
+     *
+     *  Once reading the buffer has failed nothing is streamed anymore, and
+     *  the sensors should be polled instead.
+     */
+    bool streams(const SensorSet::key_type& sensor) const;
+
+    /** @brief Stop or restart sampling while the instance is quiesced.
+     *
+     *  @param[in] quiesced - Whether the instance is quiesced.
+     */
+    void quiesce(bool quiesced);
+
+    /** @brief Take the samples of a sensor since the last take.
+     *
+     *  @param[in] sensor - The sensor.
+     *
+     *  @return - The summary, std::nullopt if there are no new samples.
+     */
+    std::optional<Summary> take(const SensorSet::key_type& sensor);
+
+    /** @brief Summarise a block of whole scans.
+     *
+     *  @param[in] data - The scans.
+     *  @param[in] size - Bytes of data.
+     */
+    void consume(const uint8_t* data, size_t size);
+
+  private:
+    struct Channel
+    {
+        /** @brief Position in the scan layout. */
+        size_t position;
+        Calibration calibration;
+        Summary summary;
+    };
+
+    /** @brief Read everything available from the buffer. */
+    void readable();
+
+    /** @brief Stop streaming, leaving the channels to be polled. */
+    void fail();
+
+    /** @brief Disable the buffer. */
+    void disable() noexcept;
+
+    std::string _devicePath;
+    std::map<SensorSet::key_type, Channel> _channels;
+    std::optional<ScanLayout> _layout;
+    std::vector<uint8_t> _block;
+    std::unique_ptr<RawRing> _ring;
+    int _fd = -1;
+    std::optional<sdeventplus::source::IO> _source;
+    bool _failed = false;
+};
+
+} // namespace iio
@@ -0,0 +1,85 @@
+#include "latency.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace hwmon
+{
+
+LatencyTracker::Move LatencyTracker::record(const SensorSet::key_type& sensor,
+                                            Clock::duration latency)
+{
+    auto& entry = _entries[sensor];
+
+    entry.samples.push_back(latency);
+    if (entry.samples.size() > window)
+    {
+        entry.samples.pop_front();
+    }
+    entry.ewma = entry.samples.size() == 1
+                     ? latency
+                     : (entry.ewma * 7 + latency) / 8;
+
+    if (!entry.timeout)
+    {
+        entry.streak = latency > _budget ? entry.streak + 1 : 0;
+        if (entry.streak < isolateAfter)
+        {
+            return Move::none;
+        }
+
+        // Give the read time to finish when the sensor is merely slow,
+        // without waiting on it for as long when it stalls.
+        entry.timeout = std::chrono::ceil<std::chrono::milliseconds>(
+            std::max(p99(entry) * 2, _budget));
+        entry.streak = 0;
+        return Move::toAsync;
+    }
+
+    entry.streak = latency < _budget / 2 ? entry.streak + 1 : 0;
+    if (entry.streak < recoverAfter)
+    {
+        return Move::none;
+    }
+
+    entry.timeout.reset();
+    entry.streak = 0;
+    return Move::toSync;
+}
+
+std::optional<std::chrono::milliseconds>
+    LatencyTracker::timeout(const SensorSet::key_type& sensor) const
+{
+    auto it = _entries.find(sensor);
+    return it == _entries.end() ? std::nullopt : it->second.timeout;
+}
+
+LatencyTracker::Clock::duration
+    LatencyTracker::ewma(const SensorSet::key_type& sensor) const
+{
+    auto it = _entries.find(sensor);
+    return it == _entries.end() ? Clock::duration{0} : it->second.ewma;
+}
+
+LatencyTracker::Clock::duration
+    LatencyTracker::p99(const SensorSet::key_type& sensor) const
+{
+    auto it = _entries.find(sensor);
+    return it == _entries.end() ? Clock::duration{0} : p99(it->second);
+}
+
+LatencyTracker::Clock::duration LatencyTracker::p99(const Entry& entry)
+{
+    if (entry.samples.empty())
+    {
+        return Clock::duration{0};
+    }
+
+    std::vector<Clock::duration> sorted(entry.samples.begin(),
+                                        entry.samples.end());
+    auto n = sorted.begin() + (sorted.size() * 99 + 99) / 100 - 1;
+    std::nth_element(sorted.begin(), n, sorted.end());
+    return *n;
+}
+
+} // namespace hwmon
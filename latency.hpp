@@ -0,0 +1,102 @@
+#pragma once
+
+#include "sensorset.hpp"
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <optional>
+
+namespace hwmon
+{
+
+/** @class LatencyTracker
+ *  @brief Tracks read latencies to move slow sensors onto async reads.
+ *  @details Each sensor's latency is kept as an EWMA and a p99 over its
+ *  recent reads.  A sensor over the latency budget on several reads in a
+ *  row is isolated: it is read asynchronously, with a timeout of twice
+ *  its p99 but no less than the budget, so it can't hold up the others.
+ *  Once it has stayed under half the budget for a while it is moved back.
+ */
+class LatencyTracker
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Reads kept for the p99. */
+    static constexpr size_t window = 100;
+    /** @brief Reads over budget in a row to isolate a sensor. */
+    static constexpr size_t isolateAfter = 3;
+    /** @brief Reads under half the budget in a row to move it back. */
+    static constexpr size_t recoverAfter = 10;
+
+    /** @brief A change in how a sensor is read. */
+    enum class Move
+    {
+        none,
+        toAsync,
+        toSync,
+    };
+
+    LatencyTracker() = delete;
+
+    /** @brief Constructor
+     *
+     *  @param[in] budget - The latency a sensor read should stay within.
+     */
+    explicit LatencyTracker(Clock::duration budget) : _budget(budget) {}
+
+    /** @brief Record the latency of a completed read.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *  @param[in] latency - How long the read took.
+     *
+     *  @return - Whether the sensor moved to or from async reads.
+     */
+    Move record(const SensorSet::key_type& sensor, Clock::duration latency);
+
+    /** @brief Get the async read timeout of an isolated sensor.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *
+     *  @return - The timeout, std::nullopt if the sensor is read
+     *            synchronously.
+     */
+    std::optional<std::chrono::milliseconds>
+        timeout(const SensorSet::key_type& sensor) const;
+
+    /** @brief Get the moving average latency of a sensor.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     */
+    Clock::duration ewma(const SensorSet::key_type& sensor) const;
+
+    /** @brief Get the p99 latency of a sensor's recent reads.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     */
+    Clock::duration p99(const SensorSet::key_type& sensor) const;
+
+  private:
+    struct Entry
+    {
+        /** @brief Recent latencies, oldest first. */
+        std::deque<Clock::duration> samples;
+        /** @brief Moving average latency. */
+        Clock::duration ewma{0};
+        /** @brief Reads in a row over budget, or under half of it. */
+        size_t streak = 0;
+        /** @brief Async read timeout while isolated. */
+        std::optional<std::chrono::milliseconds> timeout;
+    };
+
+    /** @brief The p99 of an entry's samples. */
+    static Clock::duration p99(const Entry& entry);
+
+    /** @brief The latency budget. */
+    Clock::duration _budget;
+    /** @brief The latencies of each sensor read so far. */
+    std::map<SensorSet::key_type, Entry> _entries;
+};
+
+} // namespace hwmon
@@ -0,0 +1,45 @@
+#include "load_shed.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace hwmon
+{
+
+std::tuple<bool, uint64_t, size_t, bool, uint64_t>
+    LoadShed::rank(const SensorSet::key_type& sensor) const
+{
+    auto it = _priorities.find(sensor);
+    auto priority = it == _priorities.end()
+                        ? std::numeric_limits<size_t>::max()
+                        : it->second;
+    auto deferral = _deferred.find(sensor);
+    if (deferral == _deferred.end())
+    {
+        return {true, 0, priority, true, 0};
+    }
+
+    // Aged past the limit, read ahead of the priorities, oldest first.
+    auto since = deferral->second;
+    if (_maxDeferrals > 0 && _cycles - since >= _maxDeferrals)
+    {
+        return {false, since, priority, false, since};
+    }
+    return {true, 0, priority, false, since};
+}
+
+void LoadShed::sort(std::vector<SensorSet::key_type>& sensors)
+{
+    ++_cycles;
+    if (_priorities.empty() && _deferred.empty())
+    {
+        return;
+    }
+
+    std::stable_sort(sensors.begin(), sensors.end(),
+                     [this](const auto& a, const auto& b) {
+                         return rank(a) < rank(b);
+                     });
+}
+
+} // namespace hwmon
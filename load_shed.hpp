@@ -0,0 +1,108 @@
+#pragma once
+
+#include "sensorset.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace hwmon
+{
+
+/** @class LoadShed
+ *  @brief Orders reads by priority and tracks the reads shed by overruns.
+ *  @details When a cycle runs past its interval the sensors it hasn't got
+ *  to yet are deferred to the next cycle rather than delaying it.  To make
+ *  sure the important sensors are the ones read, cycles read sensors in
+ *  Priority order, 0 being the highest.  Sensors without a priority come
+ *  last, and within a priority deferred sensors come first, the longest
+ *  deferred first, so they take turns rather than being starved by the
+ *  others.  A sensor deferred by too many cycles in a row is read ahead
+ *  of every priority, so even the least important sensors are read now
+ *  and then.
+ */
+class LoadShed
+{
+  public:
+    /** @brief Deferrals in a row after which a sensor is read first, by
+     *         default. */
+    static constexpr uint64_t defaultMaxDeferrals = 3;
+
+    /** @brief Set how many cycles in a row a sensor may be deferred for
+     *         before it's read ahead of higher priorities.
+     *
+     *  @param[in] cycles - The cycles, 0 to never read it early.
+     */
+    inline void maxDeferrals(uint64_t cycles)
+    {
+        _maxDeferrals = cycles;
+    }
+
+    /** @brief Record the priority of a sensor.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *  @param[in] priority - The sensor's priority, 0 being the highest.
+     */
+    inline void priority(const SensorSet::key_type& sensor, size_t priority)
+    {
+        _priorities[sensor] = priority;
+    }
+
+    /** @brief Reorder sensors highest priority first.
+     *
+     *  The order is otherwise kept, apart from deferred sensors moving
+     *  ahead of the others with the same priority, those deferred by the
+     *  earliest cycle first.  Sensors deferred by the maximum number of
+     *  cycles come before all of them.  Called once per cycle.
+     *
+     *  @param[in,out] sensors - The sensors to read.
+     */
+    void sort(std::vector<SensorSet::key_type>& sensors);
+
+    /** @brief Defer a sensor to the next cycle.
+     *
+     *  A sensor deferred again before it's read keeps its place.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     */
+    inline void defer(const SensorSet::key_type& sensor)
+    {
+        _deferred.emplace(sensor, _cycles);
+    }
+
+    /** @brief Whether a sensor was deferred and hasn't been read since.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     */
+    inline bool deferred(const SensorSet::key_type& sensor) const
+    {
+        return _deferred.count(sensor) > 0;
+    }
+
+    /** @brief Record that a sensor was read.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     */
+    inline void read(const SensorSet::key_type& sensor)
+    {
+        _deferred.erase(sensor);
+    }
+
+  private:
+    /** @brief The sort rank of a sensor, lowest first. */
+    std::tuple<bool, uint64_t, size_t, bool, uint64_t>
+        rank(const SensorSet::key_type& sensor) const;
+
+    /** @brief The priority of each sensor. */
+    std::map<SensorSet::key_type, size_t> _priorities;
+    /** @brief Sensors deferred by an overrun, and the cycle deferring them. */
+    std::map<SensorSet::key_type, uint64_t> _deferred;
+    /** @brief Cycles sorted so far. */
+    uint64_t _cycles = 0;
+    /** @brief Deferrals in a row after which a sensor is read first. */
+    uint64_t _maxDeferrals = defaultMaxDeferrals;
+};
+
+} // namespace hwmon
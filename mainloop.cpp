@@ -17,11 +17,28 @@
 
 #include "mainloop.hpp"
 
+#include "adaptive.hpp"
+#include "alarm_watch.hpp"
+#include "bus_lock.hpp"
+#include "control.hpp"
+#include "device_watch.hpp"
 #include "env.hpp"
 #include "fan_pwm.hpp"
 #include "fan_speed.hpp"
+#include "gpio_group.hpp"
 #include "hwmon.hpp"
 #include "hwmonio.hpp"
+#include "iio.hpp"
+#include "iio_buffer.hpp"
+#include "latency.hpp"
+#include "load_shed.hpp"
+#include "page_order.hpp"
+#include "period_monitor.hpp"
+#include "phase_timer.hpp"
+#include "power_state.hpp"
+#include "rate_control.hpp"
+#include "recovery.hpp"
+#include "rt.hpp"
 #include "sensor.hpp"
 #include "sensorset.hpp"
 #include "sysfs.hpp"
@@ -32,8 +49,11 @@
 #include <phosphor-logging/elog-errors.hpp>
 #include <xyz/openbmc_project/Sensor/Device/error.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <cstdlib>
+#include <filesystem>
 #include <format>
 #include <functional>
 #include <future>
@@ -293,6 +313,16 @@ std::optional<ObjectStateData> MainLoop::getObject(
             return {};
         }
 
+        // A sensor that has never been read isn't published until it can
+        // be, rather than holding up the others.
+        auto probing =
+            _partialStartup && !_sensorObjects.contains(sensorSetKey);
+        if (probing && _rmSensors.find(sensorSetKey) != _rmSensors.end())
+        {
+            // Already reported, probed again after the next cycle.
+            return {};
+        }
+
         using namespace sdbusplus::xyz::openbmc_project::Sensor::Device::Error;
         report<ReadFailure>(
             xyz::openbmc_project::Sensor::Device::ReadFailure::CALLOUT_ERRNO(
@@ -303,6 +333,20 @@ std::optional<ObjectStateData> MainLoop::getObject(
         log<level::INFO>(std::format("Failing sysfs file: {} errno: {}", file,
                                      e.code().value())
                              .c_str());
+
+        if (probing)
+        {
+            // Probed again after each cycle, see addDroppedSensors().
+            _rmSensors[std::move(sensorSetKey)] = std::move(sensorAttrs);
+            return {};
+        }
+
+        if (hwmon::degrade(_devPath))
+        {
+            // Added once it can be read again.
+            _rmSensors[std::move(sensorSetKey)] = std::move(sensorAttrs);
+            return {};
+        }
         exit(EXIT_FAILURE);
     }
     auto sensorValue = valueInterface->value();
@@ -314,6 +358,17 @@ std::optional<ObjectStateData> MainLoop::getObject(
                                  std::get<sensorID>(properties), sensorValue,
                                  info, scale);
 
+    if (env::getEnv("PROGRAM_LIMITS") == "true")
+    {
+        // Let the hardware raise the threshold alarms, see ALARM_NOTIFY.
+        programThresholds<WarningObject>(sensorSetKey,
+                                         std::get<sensorID>(properties),
+                                         *sensorObj, _ioAccess, info);
+        programThresholds<CriticalObject>(sensorSetKey,
+                                          std::get<sensorID>(properties),
+                                          *sensorObj, _ioAccess, info);
+    }
+
     auto target =
         addTarget<hwmon::FanSpeed>(sensorSetKey, _ioAccess, _devPath, info);
     if (target)
@@ -322,6 +377,13 @@ std::optional<ObjectStateData> MainLoop::getObject(
     }
     addTarget<hwmon::FanPwm>(sensorSetKey, _ioAccess, _devPath, info);
 
+    // Keep the attributes read every cycle open in real-time mode, so that
+    // reading them doesn't allocate.
+    if (rt::enabled() && !sensorObj->getAsyncTimeout())
+    {
+        sensorObj->openInput();
+    }
+
     // All the interfaces have been created.  Go ahead
     // and emit InterfacesAdded.
     valueInterface->emit_object_added();
@@ -342,7 +404,9 @@ MainLoop::MainLoop(sdbusplus::bus_t&& bus, const std::string& param,
     _instance(), _devPath(devPath), _prefix(prefix), _root(root), _state(),
     _instanceId(instanceId), _ioAccess(ioIntf),
     _event(sdeventplus::Event::get_default()),
-    _timer(_event, std::bind(&MainLoop::read, this))
+    _timer(_event, std::bind(&MainLoop::tick, this)),
+    _cycle(_event, std::bind(&MainLoop::readNext, this),
+           std::bind(&MainLoop::cycleComplete, this))
 {
     // Strip off any trailing slashes.
     std::string p = path;
@@ -373,12 +437,20 @@ void MainLoop::run()
 {
     init();
 
+    // Everything is set up, lock it in memory if running real-time.
+    rt::setup();
+
     std::function<void()> callback(std::bind(&MainLoop::read, this));
     try
     {
-        _timer.restart(std::chrono::microseconds(_interval));
-
-        // TODO: Issue#6 - Optionally look at polling interval sysfs entry.
+        if (_fixedDelay)
+        {
+            delay();
+        }
+        else if (!_phaseTimer)
+        {
+            _timer.restart(std::chrono::microseconds(_interval));
+        }
 
         // TODO: Issue#7 - Should probably periodically check the SensorSet
         //       for new entries.
@@ -396,8 +468,51 @@ void MainLoop::run()
 
 void MainLoop::init()
 {
+    {
+        // RECOVERY_BUDGET recovers from a failure that would otherwise
+        // exit in place: the device is degraded, its sensors keep their
+        // last values marked non-functional, and it's tried again after
+        // RECOVERY_BACKOFF (ms, 1000 by default), doubling after each
+        // failed attempt up to RECOVERY_MAX_BACKOFF (ms, 60000 by
+        // default).  After RECOVERY_BUDGET failed attempts it exits.
+        auto budget = env::getEnv("RECOVERY_BUDGET");
+        if (!budget.empty())
+        {
+            std::chrono::milliseconds backoff{1000};
+            std::chrono::milliseconds maxBackoff{60000};
+            auto backoffEnv = env::getEnv("RECOVERY_BACKOFF");
+            if (!backoffEnv.empty())
+            {
+                backoff = std::chrono::milliseconds(
+                    std::strtoull(backoffEnv.c_str(), nullptr, 10));
+            }
+            auto maxEnv = env::getEnv("RECOVERY_MAX_BACKOFF");
+            if (!maxEnv.empty())
+            {
+                maxBackoff = std::chrono::milliseconds(
+                    std::strtoull(maxEnv.c_str(), nullptr, 10));
+            }
+            _recovery = std::make_unique<hwmon::Recovery>(
+                backoff, maxBackoff,
+                std::strtoull(budget.c_str(), nullptr, 10));
+            // Mark the sensors straight away, whether a read or a fan
+            // target write degraded the device.
+            _recovery->onDegrade([this]() { markNonFunctional(); });
+        }
+    }
+
+    // With PARTIAL_STARTUP=true a sensor that can't be read at startup
+    // doesn't exit, the others are published straight away.  It's probed
+    // again after each cycle and published once it can be read.
+    _partialStartup = env::getEnv("PARTIAL_STARTUP") == "true";
+
     // Check sysfs for available sensors.
-    auto sensors = std::make_unique<SensorSet>(_hwmonRoot + '/' + _instance);
+    // IIO devices are read directly, their channels stand in for sensors.
+    auto instancePath = _hwmonRoot + '/' + _instance;
+    auto sensors =
+        iio::isDevice(instancePath)
+            ? std::make_unique<SensorSet>(iio::findSensors(instancePath))
+            : std::make_unique<SensorSet>(instancePath);
 
     for (const auto& i : *sensors)
     {
@@ -424,11 +539,83 @@ void MainLoop::init()
     }
 
     /* If there are no sensors specified by labels, exit. */
-    if (0 == _state.size())
+    // Sensors that failed at startup while recovering or partially
+    // starting are added once they can be read, and they can only be
+    // retried while running.
+    auto waiting = (_recovery || _partialStartup) && !_rmSensors.empty();
+    if (0 == _state.size() && !waiting)
     {
         exit(0);
     }
 
+    if (iio::isDevice(_hwmonRoot + '/' + _instance) &&
+        env::getEnv("IIO_STREAM") == "true")
+    {
+        streamChannels();
+    }
+
+    if (env::getEnv("ALARM_NOTIFY") == "true")
+    {
+        watchAlarms();
+    }
+
+    watchPowerState();
+
+    if (env::getEnv("REBIND") == "true")
+    {
+        watchDevice();
+    }
+
+    auto budget = env::getEnv("CYCLE_BUDGET");
+    if (env::getEnv("LOAD_SHED") == "true" || !budget.empty())
+    {
+        // With LOAD_SHED=true a cycle that runs past INTERVAL leaves the
+        // sensors it hasn't read yet for the next one.  Sensors are read in
+        // order of their published Priority so those are the least
+        // important ones, unless deferred MAX_DEFERRALS (3 by default)
+        // cycles in a row.  CYCLE_BUDGET (ms) stops cycles at a budget
+        // other than the interval.
+        _shed = true;
+        if (!budget.empty())
+        {
+            _cycleBudget = std::chrono::milliseconds(
+                std::strtoull(budget.c_str(), nullptr, 10));
+        }
+        auto maxDeferrals = env::getEnv("MAX_DEFERRALS");
+        if (!maxDeferrals.empty())
+        {
+            _loadShed.maxDeferrals(
+                std::strtoull(maxDeferrals.c_str(), nullptr, 10));
+        }
+        for (auto& [sensorSetKey, sensorStateTuple] : _state)
+        {
+            auto& obj =
+                std::get<InterfaceMap>(std::get<ObjectInfo>(sensorStateTuple));
+            auto it = obj.find(InterfaceType::PRIORITY);
+            if (it != obj.end())
+            {
+                auto& priority =
+                    std::any_cast<std::shared_ptr<PriorityObject>&>(
+                        it->second);
+                _loadShed.priority(sensorSetKey, priority->priority());
+            }
+        }
+    }
+
+    {
+        // On multi-page PMBus devices, READ_ORDER=page reads the sensors
+        // page by page to save PAGE writes.  A sensor's page is PAGE_<item><X>
+        // or is derived from its label.
+        _readByPage = env::getEnv("READ_ORDER") == "page";
+        if (_readByPage)
+        {
+            for (const auto& [sensorSetKey, sensorStateTuple] : _state)
+            {
+                setPage(sensorSetKey);
+            }
+        }
+    }
+
     {
         std::stringstream ss;
         std::string id = _instanceId;
@@ -440,6 +627,11 @@ void MainLoop::init()
         ss << _prefix << "-" << id << ".Hwmon1";
 
         _bus.request_name(ss.str().c_str());
+
+        auto controlPath = "/xyz/openbmc_project/hwmon/" + id;
+        _control = std::make_unique<hwmon::Control>(
+            _bus, controlPath.c_str(), _event,
+            [this](bool quiesced) { quiesceChanged(quiesced); });
     }
 
     {
@@ -449,224 +641,1495 @@ void MainLoop::init()
             _interval = std::strtoull(interval.c_str(), nullptr, 10);
         }
     }
-}
 
-void MainLoop::read()
-{
-    // TODO: Issue#3 - Need to make calls to the dbus sensor cache here to
-    //       ensure the objects all exist?
-
-    // Iterate through all the sensors.
-    for (auto& [sensorSetKey, sensorStateTuple] : _state)
     {
-        const auto& [sensorSysfsType, sensorSysfsNum] = sensorSetKey;
-        auto& [attrs, unused, objInfo] = sensorStateTuple;
+        // Drivers that cache register values only refresh them every
+        // update_interval, polling faster just rereads the cached values.
+        // With SYNC_UPDATE_INTERVAL=true the chip is first asked to convert
+        // at the polling interval instead.
+        auto path = _ioAccess->path();
+        auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::microseconds(_interval));
+        if (env::getEnv("SYNC_UPDATE_INTERVAL") == "true" &&
+            interval.count() > 0)
+        {
+            hwmonio::writeUpdateInterval(path, interval);
+        }
 
-        if (attrs.find(hwmon::entry::input) == attrs.end())
+        auto chip = hwmonio::readUpdateInterval(path);
+        if (chip && *chip > interval)
         {
-            continue;
+            log<level::INFO>("Polling at the chip update interval",
+                             entry("INTERVAL=%lld",
+                                   static_cast<long long>(chip->count())));
+            _interval = std::chrono::microseconds(*chip).count();
+        }
+    }
+
+    {
+        // ADAPTIVE_MAX (ms) polls the sensors with thresholds anywhere from
+        // every INTERVAL to every ADAPTIVE_MAX, faster the closer they are
+        // to a bound.  Within ADAPTIVE_MARGIN percent of a bound, 10 by
+        // default, they're polled every INTERVAL.
+        auto max = env::getEnv("ADAPTIVE_MAX");
+        if (!max.empty())
+        {
+            double margin = 10;
+            auto marginEnv = env::getEnv("ADAPTIVE_MARGIN");
+            if (!marginEnv.empty())
+            {
+                margin = std::stod(marginEnv);
+            }
+
+            auto min = std::chrono::microseconds(_interval);
+            _adaptive = std::make_unique<hwmon::Adaptive>(
+                min,
+                std::max<hwmon::Adaptive::Clock::duration>(
+                    min, std::chrono::milliseconds(
+                             std::strtoull(max.c_str(), nullptr, 10))),
+                margin / 100);
         }
+    }
 
-        // Read value from sensor.
-        std::string input = hwmon::entry::input;
-        if (sensorSysfsType == hwmon::type::pwm)
+    {
+        // Optionally yield to the event loop after spending READ_BUDGET
+        // microseconds reading sensors, so D-Bus requests such as fan
+        // target writes aren't held up behind a slow device.
+        auto budget = env::getEnv("READ_BUDGET");
+        if (!budget.empty())
         {
-            input = "";
+            _cycle.budget(std::chrono::microseconds(
+                std::strtoull(budget.c_str(), nullptr, 10)));
         }
-        // If type is power and AVERAGE_power* is true in env, use average
-        // instead of input
-        else if ((sensorSysfsType == hwmon::type::power) &&
-                 (phosphor::utility::isAverageEnvSet(sensorSetKey)))
+    }
+
+    {
+        // READ_PACE=true spreads the reads of a cycle evenly across the
+        // interval, READ_BATCH sensors (1 by default) at a time, instead of
+        // reading them back to back.  This overrides READ_BUDGET.
+        if (env::getEnv("READ_PACE") == "true")
         {
-            input = hwmon::entry::average;
+            _paceBatch = 1;
+            auto batch = env::getEnv("READ_BATCH");
+            if (!batch.empty())
+            {
+                _paceBatch = std::max<size_t>(
+                    1, std::strtoull(batch.c_str(), nullptr, 10));
+            }
         }
+    }
 
-        SensorValueType value;
-        auto& obj = std::get<InterfaceMap>(objInfo);
-        std::unique_ptr<sensor::Sensor>& sensor = _sensorObjects[sensorSetKey];
+    {
+        // FAULT_REFRESH and AVERAGE_INTERVAL_REFRESH are how long the fault
+        // and average_interval attributes are cached for between reads, in
+        // milliseconds.  By default they are read every cycle.
+        auto fault = env::getEnv("FAULT_REFRESH");
+        if (!fault.empty())
+        {
+            _faultRefresh = std::chrono::milliseconds(
+                std::strtoull(fault.c_str(), nullptr, 10));
+        }
+        auto interval = env::getEnv("AVERAGE_INTERVAL_REFRESH");
+        if (!interval.empty())
+        {
+            _averageIntervalRefresh = std::chrono::milliseconds(
+                std::strtoull(interval.c_str(), nullptr, 10));
+        }
+    }
 
-        auto& statusIface = std::any_cast<std::shared_ptr<StatusObject>&>(
-            obj[InterfaceType::STATUS]);
-        // As long as addStatus is called before addValue, statusIface
-        // should never be nullptr.
-        assert(statusIface);
+    {
+        // GPIO_SETTLE is how long GPIO gated sensors are given to settle
+        // after unlocking, GPIO_HOLD how long the GPIO is then left
+        // unlocked for, both in milliseconds.
+        auto settle = env::getEnv("GPIO_SETTLE");
+        if (!settle.empty())
+        {
+            _gpioSettle = std::chrono::milliseconds(
+                std::strtoull(settle.c_str(), nullptr, 10));
+        }
+        auto hold = env::getEnv("GPIO_HOLD");
+        if (!hold.empty())
+        {
+            _gpioHold = std::chrono::milliseconds(
+                std::strtoull(hold.c_str(), nullptr, 10));
+        }
+    }
 
-        try
+    {
+        // TIMER_POLICY=fixed-rate starts the cycles at absolute deadlines
+        // every INTERVAL, skipping those missed by a late cycle, so the
+        // period doesn't drift.  TIMER_POLICY=fixed-delay starts each cycle
+        // INTERVAL after the previous one completed instead.
+        // PHASE_ALIGN=true starts the cycles at multiples of INTERVAL on
+        // CLOCK_MONOTONIC plus PHASE_OFFSET microseconds, so instances wake
+        // up together or at a fixed stagger from one another rather than
+        // whenever they happened to start.  TIMER_ACCURACY (us) is how late
+        // the cycle timer may fire, letting the kernel merge its wakeups.
+        auto policy = env::getEnv("TIMER_POLICY");
+        auto align = env::getEnv("PHASE_ALIGN") == "true";
+        auto accuracyEnv = env::getEnv("TIMER_ACCURACY");
+        _period = std::make_unique<hwmon::PeriodMonitor>(
+            std::chrono::microseconds(_interval));
+        if (policy == "fixed-delay")
+        {
+            _fixedDelay = true;
+        }
+        else if (policy == "fixed-rate" || align || !accuracyEnv.empty())
         {
-            if (sensor->hasFaultFile())
+            std::chrono::microseconds offset{0};
+            auto offsetEnv = env::getEnv("PHASE_OFFSET");
+            if (!offsetEnv.empty())
             {
-                auto fault = _ioAccess->read(sensorSysfsType, sensorSysfsNum,
-                                             hwmon::entry::fault,
-                                             hwmonio::retries, hwmonio::delay);
-                // Skip reading from a sensor with a valid fault file
-                // and set the functional property accordingly
-                if (!statusIface->functional((fault == 0) ? true : false))
-                {
-                    continue;
-                }
+                offset = std::chrono::microseconds(
+                    std::strtoull(offsetEnv.c_str(), nullptr, 10));
             }
-
+            std::chrono::microseconds accuracy = std::chrono::milliseconds(1);
+            if (!accuracyEnv.empty())
             {
-                // RAII object for GPIO unlock / lock
-                auto locker = sensor::gpioUnlock(sensor->getGpio());
-
-                // For sensors with attribute ASYNC_READ_TIMEOUT,
-                // spawn a thread with timeout
-                auto asyncReadTimeout =
-                    env::getEnv("ASYNC_READ_TIMEOUT", sensorSetKey);
-                if (!asyncReadTimeout.empty())
-                {
-                    std::chrono::milliseconds asyncTimeout{
-                        std::stoi(asyncReadTimeout)};
-                    value = sensor::asyncRead(
-                        sensorSetKey, _ioAccess, asyncTimeout, _timedoutMap,
-                        sensorSysfsType, sensorSysfsNum, input,
-                        hwmonio::retries, hwmonio::delay);
-                }
-                else
-                {
-                    // Retry for up to a second if device is busy
-                    // or has a transient error.
-                    value =
-                        _ioAccess->read(sensorSysfsType, sensorSysfsNum, input,
-                                        hwmonio::retries, hwmonio::delay);
-                }
+                accuracy = std::chrono::microseconds(
+                    std::strtoull(accuracyEnv.c_str(), nullptr, 10));
+            }
 
-                // Set functional property to true if we could read sensor
-                statusIface->functional(true);
+            _phaseTimer = std::make_unique<hwmon::PhaseTimer>(
+                _event, std::chrono::microseconds(_interval), align, offset,
+                accuracy, std::bind(&MainLoop::tick, this));
+        }
+    }
 
-                value = sensor->adjustValue(value);
+    {
+        // BUS_LOCK=true shares a lock on the device's I2C bus with other
+        // processes using it, held around each batch of reads for up to
+        // BUS_LOCK_HOLD (ms, 50 by default) at a time.  The reads are
+        // skipped after waiting BUS_LOCK_TIMEOUT (ms, the hold time by
+        // default) for it.
+        auto bus = hwmon::i2cBus(_devPath);
+        if (env::getEnv("BUS_LOCK") == "true" && bus)
+        {
+            std::chrono::milliseconds hold{50};
+            auto holdEnv = env::getEnv("BUS_LOCK_HOLD");
+            if (!holdEnv.empty())
+            {
+                hold = std::chrono::milliseconds(
+                    std::strtoull(holdEnv.c_str(), nullptr, 10));
+            }
 
-                if (input == hwmon::entry::average)
-                {
-                    // Calculate the values of averageMap based on current
-                    // average value, current average_interval value, previous
-                    // average value, previous average_interval value
-                    int64_t interval =
-                        _ioAccess->read(sensorSysfsType, sensorSysfsNum,
-                                        hwmon::entry::caverage_interval,
-                                        hwmonio::retries, hwmonio::delay);
-                    auto ret = _average.getAverageValue(sensorSetKey);
-                    assert(ret);
-
-                    const auto& [preAverage, preInterval] = *ret;
-
-                    auto calValue = Average::calcAverage(
-                        preAverage, preInterval, value, interval);
-                    if (calValue)
-                    {
-                        // Update previous values in averageMap before the
-                        // variable value is changed next
-                        _average.setAverageValue(
-                            sensorSetKey, std::make_pair(value, interval));
-                        // Update value to be calculated average
-                        value = calValue.value();
-                    }
-                    else
-                    {
-                        // the value of
-                        // power*_average_interval is not changed yet, use the
-                        // previous calculated average instead. So skip dbus
-                        // update.
-                        continue;
-                    }
-                }
+            _busLockTimeout = hold;
+            auto timeoutEnv = env::getEnv("BUS_LOCK_TIMEOUT");
+            if (!timeoutEnv.empty())
+            {
+                _busLockTimeout = std::chrono::milliseconds(
+                    std::strtoull(timeoutEnv.c_str(), nullptr, 10));
             }
 
-            updateSensorInterfaces(obj, value);
+            try
+            {
+                _busLock = std::make_unique<hwmon::BusLock>(
+                    hwmon::BusLock::path(*bus), hold);
+                _cycle.onYield([this]() { unlockBus(); });
+            }
+            catch (const std::system_error& e)
+            {
+                log<level::ERR>("Unable to open the bus lock",
+                                entry("ERROR=%s", e.what()));
+            }
         }
-        catch (const std::system_error& e)
-        {
-#if UPDATE_FUNCTIONAL_ON_FAIL
-            // If UPDATE_FUNCTIONAL_ON_FAIL is defined and an exception was
-            // thrown, set the functional property to false.
-            // We cannot set this with the 'continue' in the lower block
-            // as the code may exit before reaching it.
-            statusIface->functional(false);
-#endif
-            auto file = sysfs::make_sysfs_path(
-                _ioAccess->path(), sensorSysfsType, sensorSysfsNum, input);
+    }
 
-            // Check sensorAdjusts for sensor removal RCs
-            auto& sAdjusts = _sensorObjects[sensorSetKey]->getAdjusts();
-            if (sAdjusts.rmRCs.count(e.code().value()) > 0)
+    {
+        // RATE_CONTROL=true backs off the poll rate of a device that returns
+        // errors or whose read latency spikes to RATE_LATENCY_SPIKE (2 by
+        // default) times its usual latency, down to one poll every
+        // RATE_MAX_INTERVAL (ms, 8 * INTERVAL by default).  The rate
+        // recovers over the following clean cycles.
+        if (env::getEnv("RATE_CONTROL") == "true")
+        {
+            std::chrono::microseconds min(_interval);
+            std::chrono::microseconds max = min * 8;
+            auto maxEnv = env::getEnv("RATE_MAX_INTERVAL");
+            if (!maxEnv.empty())
             {
-                // Return code found in sensor return code removal list
-                if (_rmSensors.find(sensorSetKey) == _rmSensors.end())
-                {
-                    // Trace for sensor not already removed from dbus
-                    log<level::INFO>("Remove sensor from dbus for read fail",
-                                     entry("FILE=%s", file.c_str()),
-                                     entry("RC=%d", e.code().value()));
-                    // Mark this sensor to be removed from dbus
-                    _rmSensors[sensorSetKey] = attrs;
-                }
-                continue;
+                max = std::chrono::milliseconds(
+                    std::strtoull(maxEnv.c_str(), nullptr, 10));
+            }
+            double spike = 2;
+            auto spikeEnv = env::getEnv("RATE_LATENCY_SPIKE");
+            if (!spikeEnv.empty())
+            {
+                spike = std::stod(spikeEnv);
             }
-#if UPDATE_FUNCTIONAL_ON_FAIL
-            // Do not exit with failure if UPDATE_FUNCTIONAL_ON_FAIL is set
-            continue;
-#endif
-            using namespace sdbusplus::xyz::openbmc_project::Sensor::Device::
-                Error;
-            report<ReadFailure>(
-                xyz::openbmc_project::Sensor::Device::ReadFailure::
-                    CALLOUT_ERRNO(e.code().value()),
-                xyz::openbmc_project::Sensor::Device::ReadFailure::
-                    CALLOUT_DEVICE_PATH(_devPath.c_str()));
 
-            log<level::INFO>(std::format("Failing sysfs file: {} errno: {}",
-                                         file, e.code().value())
-                                 .c_str());
+            _rateControl =
+                std::make_unique<hwmon::RateControl>(min, max, spike);
+        }
+        _control->set(hwmon::Control::effectiveInterval, _interval);
+    }
 
-            exit(EXIT_FAILURE);
+    {
+        // AUTO_ASYNC=true moves sensors that keep taking longer than
+        // AUTO_ASYNC_BUDGET (ms, 100 by default) to read onto async reads,
+        // as if ASYNC_READ_TIMEOUT had been set for them, until they
+        // recover.
+        if (env::getEnv("AUTO_ASYNC") == "true")
+        {
+            std::chrono::milliseconds budget{100};
+            auto budgetEnv = env::getEnv("AUTO_ASYNC_BUDGET");
+            if (!budgetEnv.empty())
+            {
+                budget = std::chrono::milliseconds(
+                    std::strtoull(budgetEnv.c_str(), nullptr, 10));
+            }
+            _latency = std::make_unique<hwmon::LatencyTracker>(budget);
         }
     }
+}
 
-    removeSensors();
+void MainLoop::setPage(const SensorSet::key_type& sensorSetKey)
+{
+    auto page = env::getEnv("PAGE", sensorSetKey);
+    if (!page.empty())
+    {
+        int value = 0;
+        auto [ptr, ec] =
+            std::from_chars(page.data(), page.data() + page.size(), value);
+        if (ec == std::errc() && ptr == page.data() + page.size())
+        {
+            _pageOrder.set(sensorSetKey, value);
+            return;
+        }
 
-    addDroppedSensors();
+        // Fall back on the label rather than fail to start.
+        log<level::ERR>("Invalid PAGE",
+                        entry("SENSOR=%s%s", sensorSetKey.first.c_str(),
+                              sensorSetKey.second.c_str()),
+                        entry("PAGE=%s", page.c_str()));
+    }
+
+    auto label = env::getIndirectID(_hwmonRoot + '/' + _instance + '/',
+                                    hwmon::entry::label, sensorSetKey);
+    if (auto p = hwmon::pageFromLabel(label))
+    {
+        _pageOrder.set(sensorSetKey, *p);
+    }
 }
 
-void MainLoop::removeSensors()
+void MainLoop::tick()
 {
-    // Remove any sensors marked for removal
-    for (const auto& i : _rmSensors)
+    if (auto missed = _period->tick(std::chrono::steady_clock::now()))
     {
-        // Remove sensor object from dbus using emit_object_removed()
-        auto& objInfo = std::get<ObjectInfo>(_state[i.first]);
-        auto& objPath = std::get<std::string>(objInfo);
+        _control->add(hwmon::Control::skippedTicks, missed);
+    }
+    _control->set(hwmon::Control::periodJitter,
+                  std::chrono::duration_cast<std::chrono::microseconds>(
+                      _period->jitter())
+                      .count());
 
-        _bus.emit_object_removed(objPath.c_str());
+    if (_cycle.running())
+    {
+        // The last cycle overran, this tick is dropped rather than queued.
+        _control->add(hwmon::Control::skippedTicks);
+    }
 
-        // Erase sensor object info
-        _state.erase(i.first);
+    read();
+
+    if (_fixedDelay && !_cycle.running() && !_timer.isEnabled())
+    {
+        // No cycle was started, so none will arm the timer once it
+        // completes.  One that completed straight away already has.
+        delay();
     }
 }
 
-void MainLoop::addDroppedSensors()
+void MainLoop::delay()
 {
-    // Attempt to add any sensors that were removed
-    auto it = _rmSensors.begin();
-    while (it != _rmSensors.end())
+    _timer.restartOnce(std::chrono::microseconds(_interval));
+    _period->wait(std::chrono::steady_clock::now());
+}
+
+void MainLoop::read()
+{
+    // TODO: Issue#3 - Need to make calls to the dbus sensor cache here to
+    //       ensure the objects all exist?
+
+    if (quiesced())
     {
-        if (_state.find(it->first) == _state.end())
+        return;
+    }
+
+    if (_detached)
+    {
+        // Uevents can be lost, so look for the instance as well.
+        auto instance = hwmon::findInstance(_deviceWatch->device());
+        if (instance.empty())
         {
-            SensorSet::container_t::value_type ssValueType =
-                std::make_pair(it->first, it->second);
+            return;
+        }
+        attach(instance);
+    }
 
-            auto object = getObject(ssValueType);
-            if (object)
-            {
-                // Construct the SensorSet value
-                // std::tuple<SensorSet::mapped_type,
-                //            std::string(Sensor Label),
-                //            ObjectInfo>
-                auto value = std::make_tuple(std::move(ssValueType.second),
-                                             std::move((*object).first),
-                                             std::move((*object).second));
+    if (_cycle.running())
+    {
+        // The previous cycle yielded to the event loop and hasn't finished
+        // yet.  Let it complete rather than starting a new one.
+        return;
+    }
 
-                _state[std::move(ssValueType.first)] = std::move(value);
+    if (_rateControl &&
+        std::chrono::steady_clock::now() - _cycleStart +
+                std::chrono::microseconds(_interval) / 2 <
+            _rateControl->interval())
+    {
+        // Backed off from a struggling device, skip this tick.
+        return;
+    }
+
+    if (hwmon::degraded() && !recover())
+    {
+        // Waiting to try the device again.
+        return;
+    }
+
+    // Snapshot the sensors to read.  Sensors are only removed from or added
+    // to _state once a cycle completes so the keys stay valid while the
+    // cycle is spread across event loop iterations.
+    _cycleKeys.clear();
+    for (auto& [handle, group] : _gpioGroups)
+    {
+        group->clear();
+    }
+    auto now = hwmon::Schedule::Clock::now();
+    auto slack = std::chrono::microseconds(_interval) / 2;
+    size_t cycleSensors = 0;
+    for (const auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        // Sensors gated by a GPIO are read by the GPIO's group once the
+        // sensors have settled, rather than as part of the cycle.
+        const auto& handle = _sensorObjects[sensorSetKey]->getGpioHandle();
+        if (!handle)
+        {
+            ++cycleSensors;
+        }
+
+        // Sensors are only recorded as read once they are, so those
+        // deferred by the last cycle are still due unless suspended since.
+        if (!_schedule.due(sensorSetKey, now, slack))
+        {
+            continue;
+        }
+
+        if (handle)
+        {
+            gpioGroup(handle).add(sensorSetKey);
+            continue;
+        }
+        _cycleKeys.push_back(sensorSetKey);
+    }
+    _pageOrder.sort(_cycleKeys);
+    if (_shed)
+    {
+        _loadShed.sort(_cycleKeys);
+    }
+    _cycleNext = 0;
+    _cycleStart = now;
+    _cycleOverran = false;
+    _cycleRetries = hwmonio::retryCount();
+    _cycleErrors = 0;
+    _cycleReads = 0;
+    _cycleBusy = std::chrono::steady_clock::duration{0};
+
+    if (_paceBatch > 0 && cycleSensors > 0)
+    {
+        // The slots are sized for all of the sensors the cycle reads, not
+        // only those due this time, so the slots don't widen or narrow
+        // with sensors on a longer schedule and each sensor's period
+        // stays the same.
+        auto slots = (cycleSensors + _paceBatch - 1) / _paceBatch;
+        _cycle.pace(std::chrono::microseconds(_interval) / slots, _paceBatch);
+    }
+
+    for (auto& [handle, group] : _gpioGroups)
+    {
+        group->start();
+    }
+    _cycle.start();
+}
+
+void MainLoop::streamChannels()
+{
+    // IIO_BUFFER_LENGTH is the buffer length in scans, IIO_TRIGGER the
+    // trigger to sample on and IIO_RING a shared memory object to copy the
+    // raw scans to.  IIO_STREAM_VALUE picks the value published from the
+    // samples of each interval: min, max or mean.
+    size_t length = 1024;
+    auto lengthEnv = env::getEnv("IIO_BUFFER_LENGTH");
+    if (!lengthEnv.empty())
+    {
+        length = std::strtoull(lengthEnv.c_str(), nullptr, 10);
+    }
+
+    auto value = env::getEnv("IIO_STREAM_VALUE");
+    if (value == "min")
+    {
+        _streamValue = [](const iio::Summary& s) { return s.min; };
+    }
+    else if (value == "max")
+    {
+        _streamValue = [](const iio::Summary& s) { return s.max; };
+    }
+    else
+    {
+        _streamValue = [](const iio::Summary& s) { return s.mean(); };
+    }
+
+    std::vector<SensorSet::key_type> sensors;
+    for (const auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        sensors.push_back(sensorSetKey);
+    }
+
+    try
+    {
+        auto devicePath = _hwmonRoot + '/' + _instance;
+        _stream = std::make_unique<iio::BufferStream>(
+            _event, devicePath, iio::BufferStream::node(devicePath), sensors,
+            length, env::getEnv("IIO_TRIGGER"), env::getEnv("IIO_RING"));
+    }
+    catch (const std::system_error& e)
+    {
+        // Poll the channels instead.
+        log<level::ERR>("Unable to stream IIO channels",
+                        entry("ERROR=%s", e.what()));
+    }
+}
+
+void MainLoop::watchPowerState()
+{
+    // Sensors with POWER_DOMAIN_<item><X>=host are only powered while the
+    // host is.  While it's off they're read every POWER_OFF_INTERVAL (ms),
+    // or not at all if that isn't set.
+    for (const auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        if (env::getEnv("POWER_DOMAIN", sensorSetKey) == "host")
+        {
+            _hostSensors.push_back(sensorSetKey);
+        }
+    }
+    if (_hostSensors.empty())
+    {
+        return;
+    }
+
+    auto interval = env::getEnv("POWER_OFF_INTERVAL");
+    if (!interval.empty())
+    {
+        _powerOffInterval = std::chrono::milliseconds(
+            std::strtoull(interval.c_str(), nullptr, 10));
+    }
+
+    _powerState = std::make_unique<hwmon::PowerState>(
+        _bus, [this](bool on) { powerChanged(on); });
+    if (!_powerState->on())
+    {
+        powerChanged(false);
+    }
+}
+
+void MainLoop::powerChanged(bool on)
+{
+    for (const auto& sensorSetKey : _hostSensors)
+    {
+        if (on)
+        {
+            _schedule.throttle(sensorSetKey, std::nullopt);
+        }
+        else
+        {
+            _schedule.throttle(sensorSetKey, _powerOffInterval);
+        }
+    }
+
+    // Don't wait for the next interval to resume reading the sensors.
+    if (on && !_cycle.running())
+    {
+        read();
+    }
+}
+
+void MainLoop::quiesceChanged(bool quiesced)
+{
+    for (auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        hwmon::quiesceObject(
+            std::get<InterfaceMap>(std::get<ObjectInfo>(sensorStateTuple)),
+            quiesced);
+    }
+
+    // Alarm notifications would read the attributes, and a stream keep the
+    // device sampling.
+    if (!_detached)
+    {
+        for (auto& watch : _alarmWatches)
+        {
+            if (quiesced)
+            {
+                watch->disable();
+            }
+            else
+            {
+                watch->enable();
+            }
+        }
+    }
+    if (_stream)
+    {
+        _stream->quiesce(quiesced);
+    }
+
+    if (quiesced)
+    {
+        drain();
+        return;
+    }
+
+    if (_drainTimer)
+    {
+        _drainTimer->setEnabled(false);
+    }
+
+    // Refresh the stale values straight away.
+    if (!_cycle.running())
+    {
+        read();
+    }
+}
+
+bool MainLoop::quiesced() const
+{
+    return _control && _control->quiesced();
+}
+
+void MainLoop::drain()
+{
+    if (!quiesced())
+    {
+        return;
+    }
+
+    // A timed out read can't be cancelled, only waited out.
+    if (readsInFlight())
+    {
+        if (!_drainTimer)
+        {
+            _drainTimer = std::make_unique<
+                sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>(
+                _event, [this](auto&) { drain(); });
+        }
+        _drainTimer->restartOnce(std::chrono::milliseconds(10));
+        return;
+    }
+
+    _control->drained();
+}
+
+bool MainLoop::readsInFlight() const
+{
+    for (const auto& [sensorSetKey, future] : _timedoutMap)
+    {
+        if (future.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MainLoop::releaseTargets()
+{
+    for (auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        auto& obj =
+            std::get<InterfaceMap>(std::get<ObjectInfo>(sensorStateTuple));
+        for (auto& [type, iface] : obj)
+        {
+            switch (type)
+            {
+                case InterfaceType::FAN_SPEED:
+                    std::any_cast<std::shared_ptr<hwmon::FanSpeed>&>(iface)
+                        ->release();
+                    break;
+                case InterfaceType::FAN_PWM:
+                    std::any_cast<std::shared_ptr<hwmon::FanPwm>&>(iface)
+                        ->release();
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+void MainLoop::watchDevice()
+{
+    // IIO devices are read through their own interface.
+    auto instancePath = _hwmonRoot + '/' + _instance;
+    if (iio::isDevice(instancePath))
+    {
+        return;
+    }
+
+    std::error_code ec;
+    auto device = std::filesystem::canonical(instancePath + "/device", ec);
+    if (ec)
+    {
+        log<level::INFO>("Unable to watch for the driver being bound again",
+                         entry("INSTANCE=%s", instancePath.c_str()),
+                         entry("ERROR=%s", ec.message().c_str()));
+        return;
+    }
+
+    try
+    {
+        _deviceWatch = std::make_unique<hwmon::DeviceWatch>(
+            _event, device.string(),
+            [this](bool added, const std::string& instance) {
+                deviceChanged(added, instance);
+            });
+    }
+    catch (const std::system_error& e)
+    {
+        log<level::INFO>("Unable to watch for the driver being bound again",
+                         entry("INSTANCE=%s", instancePath.c_str()),
+                         entry("ERROR=%s", e.what()));
+        return;
+    }
+
+    // Reads and writes fail instead, until the device is back.
+    hwmonio::exitOnRemoval(false);
+}
+
+void MainLoop::deviceChanged(bool added, const std::string& instance)
+{
+    if (!added)
+    {
+        if (instance == _instance)
+        {
+            detach();
+        }
+        return;
+    }
+
+    if (_detached)
+    {
+        attach(instance);
+    }
+}
+
+void MainLoop::detach()
+{
+    if (_detached)
+    {
+        return;
+    }
+    _detached = true;
+
+    log<level::INFO>("Device removed, waiting for it to come back",
+                     entry("DEVICE=%s", _devPath.c_str()),
+                     entry("INSTANCE=%s", _instance.c_str()));
+
+    // Their attributes are gone and may never be notified again.
+    for (auto& watch : _alarmWatches)
+    {
+        watch->disable();
+    }
+
+    // The last values are kept, but can't be relied on.
+    for (auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        auto& obj =
+            std::get<InterfaceMap>(std::get<ObjectInfo>(sensorStateTuple));
+        auto it = obj.find(InterfaceType::STATUS);
+        if (it != obj.end())
+        {
+            std::any_cast<std::shared_ptr<StatusObject>&>(it->second)
+                ->functional(false);
+        }
+    }
+}
+
+void MainLoop::attach(const std::string& instance)
+{
+    _instance = instance;
+    auto path = _hwmonRoot + '/' + _instance;
+
+    // Async reads that timed out may still be using the previous access,
+    // so it's kept until they have finished.
+    _reboundIO.push_back(std::make_unique<hwmonio::HwmonIO>(path));
+    _ioAccess = _reboundIO.back().get();
+    releaseReboundIO();
+
+    for (auto& [sensorSetKey, sensor] : _sensorObjects)
+    {
+        sensor->rebind(_ioAccess);
+    }
+
+    for (auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        auto& obj =
+            std::get<InterfaceMap>(std::get<ObjectInfo>(sensorStateTuple));
+        for (auto& [type, iface] : obj)
+        {
+            switch (type)
+            {
+                case InterfaceType::FAN_SPEED:
+                    std::any_cast<std::shared_ptr<hwmon::FanSpeed>&>(iface)
+                        ->rebind(std::make_unique<hwmonio::HwmonIO>(path));
+                    break;
+                case InterfaceType::FAN_PWM:
+                    std::any_cast<std::shared_ptr<hwmon::FanPwm>&>(iface)
+                        ->rebind(std::make_unique<hwmonio::HwmonIO>(path));
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    if (!_alarmWatches.empty())
+    {
+        _alarmWatches.clear();
+        watchAlarms();
+    }
+
+    _detached = false;
+    log<level::INFO>("Device is back", entry("DEVICE=%s", _devPath.c_str()),
+                     entry("INSTANCE=%s", _instance.c_str()));
+
+    // The sensors are functional again once read.
+    releaseTargets();
+}
+
+void MainLoop::releaseReboundIO()
+{
+    // Which access a timed out read is using isn't known, so the previous
+    // ones are all kept while any of them is running.
+    if (_reboundIO.size() > 1 && !readsInFlight())
+    {
+        _reboundIO.erase(_reboundIO.begin(), _reboundIO.end() - 1);
+    }
+}
+
+void MainLoop::watchAlarms()
+{
+    // With the alarms raised by the hardware, ALARM_INTERVAL (ms) reads the
+    // watched sensors less often than INTERVAL.
+    std::chrono::milliseconds interval{0};
+    auto intervalEnv = env::getEnv("ALARM_INTERVAL");
+    if (!intervalEnv.empty())
+    {
+        interval = std::chrono::milliseconds(
+            std::strtoull(intervalEnv.c_str(), nullptr, 10));
+    }
+
+    for (const auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        const auto& [sensorSysfsType, sensorSysfsNum] = sensorSetKey;
+
+        bool watched = false;
+        for (const auto& alarm :
+             hwmon::alarmAttributes(_ioAccess->path(), sensorSetKey))
+        {
+            try
+            {
+                _alarmWatches.push_back(std::make_unique<hwmon::AlarmWatch>(
+                    _event,
+                    hwmonio::Attribute(sysfs::make_sysfs_path(
+                        _ioAccess->path(), sensorSysfsType, sensorSysfsNum,
+                        alarm)),
+                    [this, sensorSetKey](int64_t) { alarmed(sensorSetKey); }));
+                if (quiesced())
+                {
+                    _alarmWatches.back()->disable();
+                }
+                watched = true;
+            }
+            catch (const std::system_error& e)
+            {
+                log<level::INFO>("Unable to watch alarm attribute",
+                                 entry("ATTRIBUTE=%s", alarm.c_str()),
+                                 entry("ERROR=%s", e.what()));
+            }
+        }
+
+        if (watched)
+        {
+            _schedule.period(sensorSetKey, interval);
+        }
+    }
+}
+
+void MainLoop::alarmed(const SensorSet::key_type& sensorSetKey)
+{
+    auto it = _state.find(sensorSetKey);
+    if (it == _state.end() || _schedule.suspended(sensorSetKey) ||
+        awaitingRecovery() || quiesced())
+    {
+        return;
+    }
+
+    // Read the sensor now, so the thresholds and functional status on
+    // D-Bus follow the alarm without waiting for the next cycle.
+    auto& sensor = _sensorObjects[sensorSetKey];
+    sensor->getFaultCache().invalidate();
+    if (const auto& handle = sensor->getGpioHandle())
+    {
+        gpioGroup(handle).start();
+        return;
+    }
+    // If the bus is busy the sensor is left for the cycle, rather than
+    // waiting for it here.
+    if (lockBus() == hwmon::BusLock::State::held)
+    {
+        readSensor(it->first, it->second);
+        unlockBus();
+    }
+}
+
+sensor::GpioGroup& MainLoop::gpioGroup(
+    const std::shared_ptr<gpioplus::HandleInterface>& handle)
+{
+    auto& group = _gpioGroups[handle.get()];
+    if (!group)
+    {
+        group = std::make_unique<sensor::GpioGroup>(
+            _event, handle, _gpioSettle, _gpioHold,
+            [this](const std::vector<SensorSet::key_type>& sensors) {
+                for (const auto& sensorSetKey : sensors)
+                {
+                    if (awaitingRecovery() || quiesced())
+                    {
+                        break;
+                    }
+
+                    auto it = _state.find(sensorSetKey);
+                    if (it != _state.end())
+                    {
+                        if (lockBus() != hwmon::BusLock::State::held)
+                        {
+                            // The rest are read by the cycle instead.
+                            break;
+                        }
+                        readSensor(it->first, it->second);
+                        _schedule.read(sensorSetKey, _cycleStart);
+                    }
+                }
+                unlockBus();
+            });
+    }
+    return *group;
+}
+
+bool MainLoop::readNext()
+{
+    if (awaitingRecovery())
+    {
+        // The device degraded during this cycle, the rest of the sensors
+        // would only fail too, each after its retries.
+        _cycleNext = _cycleKeys.size();
+    }
+
+    if (_shed && _cycleNext < _cycleKeys.size() &&
+        std::chrono::steady_clock::now() - _cycleStart >=
+            (_cycleBudget.count() > 0 ? _cycleBudget
+                                      : std::chrono::microseconds(_interval)))
+    {
+        // Out of time, leave the rest for the next cycle rather than
+        // delaying it.  They're read first then, so they take turns with
+        // the others if the device keeps stalling.
+        for (auto i = _cycleNext; i < _cycleKeys.size(); ++i)
+        {
+            _loadShed.defer(_cycleKeys[i]);
+        }
+        _control->add(hwmon::Control::deferredReads,
+                      _cycleKeys.size() - _cycleNext);
+        _cycleNext = _cycleKeys.size();
+        _cycleOverran = true;
+    }
+
+    if (_cycleNext < _cycleKeys.size())
+    {
+        auto bus = lockBus();
+        if (bus == hwmon::BusLock::State::waiting)
+        {
+            // Try again shortly, without holding up the event loop.
+            _cycle.wait(hwmon::BusLock::retryInterval);
+            return true;
+        }
+        if (bus == hwmon::BusLock::State::timedOut)
+        {
+            // Another process has kept the bus for too long, leave the
+            // rest of the sensors for the next cycle rather than stall the
+            // event loop.
+            for (auto i = _cycleNext; i < _cycleKeys.size(); ++i)
+            {
+                _loadShed.defer(_cycleKeys[i]);
+            }
+            _control->add(hwmon::Control::deferredReads,
+                          _cycleKeys.size() - _cycleNext);
+            _cycleNext = _cycleKeys.size();
+            return false;
+        }
+
+        const auto& sensorSetKey = _cycleKeys[_cycleNext++];
+        _loadShed.read(sensorSetKey);
+        auto it = _state.find(sensorSetKey);
+        if (it != _state.end())
+        {
+            auto start = std::chrono::steady_clock::now();
+            readSensor(it->first, it->second);
+            _cycleBusy += std::chrono::steady_clock::now() - start;
+            _schedule.read(sensorSetKey, _cycleStart);
+            ++_cycleReads;
+        }
+    }
+
+    return _cycleNext < _cycleKeys.size();
+}
+
+hwmon::BusLock::State MainLoop::lockBus()
+{
+    if (!_busLock)
+    {
+        return hwmon::BusLock::State::held;
+    }
+
+    auto attempt = _busLock->lock(_busLockTimeout);
+    if (attempt.waited)
+    {
+        uint64_t us =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                *attempt.waited)
+                .count();
+        _control->add(hwmon::Control::busLockWaits);
+        _control->add(hwmon::Control::busLockWaitTime, us);
+        if (us > _control->get(hwmon::Control::busLockMaxWait))
+        {
+            _control->set(hwmon::Control::busLockMaxWait, us);
+        }
+    }
+
+    if (attempt.state == hwmon::BusLock::State::timedOut)
+    {
+        _control->add(hwmon::Control::busLockTimeouts);
+    }
+    return attempt.state;
+}
+
+void MainLoop::unlockBus()
+{
+    if (_busLock)
+    {
+        _busLock->unlock();
+    }
+}
+
+void MainLoop::cycleComplete()
+{
+    unlockBus();
+
+    if (_rateControl && _cycleReads > 0)
+    {
+        auto errors = hwmonio::retryCount() - _cycleRetries + _cycleErrors;
+        if (_rateControl->cycle(errors, _cycleBusy / _cycleReads))
+        {
+            _control->set(hwmon::Control::effectiveInterval,
+                          std::chrono::duration_cast<std::chrono::microseconds>(
+                              _rateControl->interval())
+                              .count());
+        }
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - _cycleStart);
+    if (_cycleOverran || elapsed > std::chrono::microseconds(_interval))
+    {
+        _control->add(hwmon::Control::cycleOverruns);
+    }
+    if (static_cast<uint64_t>(elapsed.count()) >
+        _control->get(hwmon::Control::maxCycleTime))
+    {
+        _control->set(hwmon::Control::maxCycleTime, elapsed.count());
+    }
+
+    if (_fixedDelay)
+    {
+        delay();
+    }
+
+    removeSensors();
+    addDroppedSensors();
+    releaseReboundIO();
+
+    if (_recovery && _recovery->finish())
+    {
+        log<level::INFO>("Device recovered",
+                         entry("DEVICE=%s", _devPath.c_str()));
+        releaseTargets();
+    }
+}
+
+void MainLoop::readSensor(const SensorSet::key_type& sensorSetKey,
+                          mapped_type& sensorStateTuple)
+{
+    const auto& [sensorSysfsType, sensorSysfsNum] = sensorSetKey;
+    auto& [attrs, unused, objInfo] = sensorStateTuple;
+
+    // Reads already queued by a cycle, GPIO group or alarm are dropped
+    // while quiesced.
+    if (attrs.find(hwmon::entry::input) == attrs.end() || quiesced())
+    {
+        return;
+    }
+
+    std::unique_ptr<sensor::Sensor>& sensor = _sensorObjects[sensorSetKey];
+
+    // Read value from sensor.
+    std::string input = hwmon::entry::input;
+    if (sensorSysfsType == hwmon::type::pwm)
+    {
+        input = "";
+    }
+    // If type is power and AVERAGE_power* is true in env, use average
+    // instead of input
+    else if (sensor->useAverage())
+    {
+        input = hwmon::entry::average;
+    }
+
+    SensorValueType value;
+    auto& obj = std::get<InterfaceMap>(objInfo);
+
+    auto& statusIface = std::any_cast<std::shared_ptr<StatusObject>&>(
+        obj[InterfaceType::STATUS]);
+    // As long as addStatus is called before addValue, statusIface
+    // should never be nullptr.
+    assert(statusIface);
+
+    if (_stream && _stream->streams(sensorSetKey))
+    {
+        // Publish the samples streamed since the last read, if there are
+        // none keep the last value.
+        if (auto summary = _stream->take(sensorSetKey))
+        {
+            statusIface->functional(true);
+            value = sensor->adjustValue(_streamValue(*summary));
+            updateSensorInterfaces(obj, value);
+        }
+        return;
+    }
+
+    bool faultChecked = false;
+    try
+    {
+        if (sensor->hasFaultFile())
+        {
+            // The fault is only read again once FAULT_REFRESH has expired.
+            // A faulted sensor isn't cached so its recovery is seen on the
+            // next cycle.
+            auto& cache = sensor->getFaultCache();
+            auto now = hwmon::AuxCache::Clock::now();
+            auto fault = cache.get(now, _faultRefresh);
+            if (!fault)
+            {
+                faultChecked = true;
+                if (auto attr = sensor->getFault())
+                {
+                    fault = attr->read(hwmonio::retries, hwmonio::delay);
+                }
+                else
+                {
+                    fault = _ioAccess->read(sensorSysfsType, sensorSysfsNum,
+                                            hwmon::entry::fault,
+                                            hwmonio::retries, hwmonio::delay);
+                }
+                if (*fault == 0)
+                {
+                    cache.set(*fault, now);
+                }
+            }
+            // Skip reading from a sensor with a valid fault file
+            // and set the functional property accordingly
+            if (!statusIface->functional((*fault == 0) ? true : false))
+            {
+                return;
+            }
+        }
+
+        // Failed reads are returned rather than thrown, the exception
+        // costing more than the read when a device keeps failing.
+        hwmonio::ReadResult result;
+        if (auto attr = sensor->getInput())
+        {
+            // Kept open in real-time mode so the read doesn't allocate.
+            result = attr->tryRead(hwmonio::retries, hwmonio::delay);
+        }
+        else
+        {
+            // For sensors with attribute ASYNC_READ_TIMEOUT, or found to be
+            // slow, spawn a thread with timeout
+            auto asyncTimeout = sensor->getAsyncTimeout();
+            if (!asyncTimeout && _latency)
+            {
+                asyncTimeout = _latency->timeout(sensorSetKey);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            if (asyncTimeout)
+            {
+                result = sensor::tryAsyncRead(
+                    sensorSetKey, _ioAccess, *asyncTimeout, _timedoutMap,
+                    sensorSysfsType, sensorSysfsNum, input, hwmonio::retries,
+                    hwmonio::delay);
+            }
+            else
+            {
+                // Retry for up to a second if device is busy
+                // or has a transient error.
+                result = _ioAccess->tryRead(sensorSysfsType, sensorSysfsNum,
+                                            input, hwmonio::retries,
+                                            hwmonio::delay);
+            }
+
+            if (_latency && !sensor->getAsyncTimeout() && result)
+            {
+                trackLatency(sensorSetKey,
+                             std::chrono::steady_clock::now() - start);
+            }
+        }
+
+#if NEGATIVE_ERRNO_ON_FAIL
+        if (!result && result.error().category() == std::generic_category())
+        {
+            result = -result.error().value();
+        }
+#endif
+        if (!result)
+        {
+            readFailed(sensorSetKey, sensorStateTuple, input, faultChecked,
+                       result.error());
+            return;
+        }
+        value = *result;
+
+        // Set functional property to true if we could read sensor
+        statusIface->functional(true);
+
+        value = sensor->adjustValue(value);
+
+        if (input == hwmon::entry::average)
+        {
+            // Calculate the values of averageMap based on current
+            // average value, current average_interval value, previous
+            // average value, previous average_interval value
+            // average_interval only changes when reconfigured, so it is
+            // read again once AVERAGE_INTERVAL_REFRESH has expired.
+            auto& cache = sensor->getAverageIntervalCache();
+            auto now = hwmon::AuxCache::Clock::now();
+            auto cached = cache.get(now, _averageIntervalRefresh);
+            int64_t interval;
+            if (cached)
+            {
+                interval = *cached;
+            }
+            else
+            {
+                interval = _ioAccess->read(sensorSysfsType, sensorSysfsNum,
+                                           hwmon::entry::caverage_interval,
+                                           hwmonio::retries, hwmonio::delay);
+                cache.set(interval, now);
+            }
+            auto ret = _average.getAverageValue(sensorSetKey);
+            assert(ret);
+
+            const auto& [preAverage, preInterval] = *ret;
+
+            auto calValue = Average::calcAverage(preAverage, preInterval,
+                                                 value, interval);
+            if (calValue)
+            {
+                // Update previous values in averageMap before the
+                // variable value is changed next
+                _average.setAverageValue(sensorSetKey,
+                                         std::make_pair(value, interval));
+                // Update value to be calculated average
+                value = calValue.value();
+            }
+            else
+            {
+                // the value of power*_average_interval is not changed yet,
+                // use the previous calculated average instead. So skip dbus
+                // update.
+                return;
+            }
+        }
+
+        updateSensorInterfaces(obj, value);
+        if (_adaptive)
+        {
+            adapt(sensorSetKey, obj, value);
+        }
+    }
+    catch (const std::system_error& e)
+    {
+        readFailed(sensorSetKey, sensorStateTuple, input, faultChecked,
+                   e.code());
+    }
+}
+
+void MainLoop::readFailed(const SensorSet::key_type& sensorSetKey,
+                          mapped_type& sensorStateTuple,
+                          const std::string& input, bool faultChecked,
+                          const std::error_code& ec)
+{
+    const auto& [sensorSysfsType, sensorSysfsNum] = sensorSetKey;
+    auto& [attrs, unused, objInfo] = sensorStateTuple;
+    auto& obj = std::get<InterfaceMap>(objInfo);
+    auto& sensor = _sensorObjects[sensorSetKey];
+    auto& statusIface = std::any_cast<std::shared_ptr<StatusObject>&>(
+        obj[InterfaceType::STATUS]);
+
+    if (_deviceWatch &&
+        (_detached || ec == std::errc::no_such_device ||
+         !std::filesystem::exists(_hwmonRoot + '/' + _instance)))
+    {
+        // The driver was unbound, the uevent may not have arrived yet.
+        detach();
+        return;
+    }
+
+    ++_cycleErrors;
+    sensor->getAverageIntervalCache().invalidate();
+    sensor->getFaultCache().invalidate();
+    if (sensor->hasFaultFile() && !faultChecked)
+    {
+        // The cached fault may be stale, a fault that has appeared
+        // since explains the failure.  If it can't be read either, handle
+        // the original failure.
+        auto fault = _ioAccess->tryRead(sensorSysfsType, sensorSysfsNum,
+                                        hwmon::entry::fault, hwmonio::retries,
+                                        hwmonio::delay);
+        if (fault && *fault != 0)
+        {
+            statusIface->functional(false);
+            return;
+        }
+    }
+
+#if UPDATE_FUNCTIONAL_ON_FAIL
+    // If UPDATE_FUNCTIONAL_ON_FAIL is defined and the read failed,
+    // set the functional property to false.
+    // We cannot set this with the 'return' in the lower block
+    // as the code may exit before reaching it.
+    statusIface->functional(false);
+#endif
+    auto file = sysfs::make_sysfs_path(_ioAccess->path(), sensorSysfsType,
+                                       sensorSysfsNum, input);
+
+    // Check sensorAdjusts for sensor removal RCs
+    auto& sAdjusts = sensor->getAdjusts();
+    if (sAdjusts.rmRCs.count(ec.value()) > 0)
+    {
+        // Return code found in sensor return code removal list
+        if (_rmSensors.find(sensorSetKey) == _rmSensors.end())
+        {
+            // Trace for sensor not already removed from dbus
+            log<level::INFO>("Remove sensor from dbus for read fail",
+                             entry("FILE=%s", file.c_str()),
+                             entry("RC=%d", ec.value()));
+            // Mark this sensor to be removed from dbus
+            _rmSensors[sensorSetKey] = attrs;
+        }
+        return;
+    }
+#if UPDATE_FUNCTIONAL_ON_FAIL
+    // Do not exit with failure if UPDATE_FUNCTIONAL_ON_FAIL is set
+    return;
+#endif
+    using namespace sdbusplus::xyz::openbmc_project::Sensor::Device::Error;
+    report<ReadFailure>(
+        xyz::openbmc_project::Sensor::Device::ReadFailure::CALLOUT_ERRNO(
+            ec.value()),
+        xyz::openbmc_project::Sensor::Device::ReadFailure::
+            CALLOUT_DEVICE_PATH(_devPath.c_str()));
+
+    log<level::INFO>(std::format("Failing sysfs file: {} errno: {}", file,
+                                 ec.value())
+                         .c_str());
+
+    if (hwmon::degrade(_devPath))
+    {
+        statusIface->functional(false);
+        return;
+    }
+    exit(EXIT_FAILURE);
+}
+
+void MainLoop::markNonFunctional()
+{
+    // The last values are kept, but can't be relied on.
+    for (auto& [sensorSetKey, sensorStateTuple] : _state)
+    {
+        auto& obj =
+            std::get<InterfaceMap>(std::get<ObjectInfo>(sensorStateTuple));
+        auto it = obj.find(InterfaceType::STATUS);
+        if (it != obj.end())
+        {
+            std::any_cast<std::shared_ptr<StatusObject>&>(it->second)
+                ->functional(false);
+        }
+    }
+}
+
+bool MainLoop::awaitingRecovery() const
+{
+    return hwmon::degraded() && !_recovery->attempting();
+}
+
+bool MainLoop::recover()
+{
+    if (!_recovery->attempt(hwmon::Recovery::Clock::now()))
+    {
+        markNonFunctional();
+        return false;
+    }
+
+    log<level::INFO>("Attempting to recover device",
+                     entry("DEVICE=%s", _devPath.c_str()),
+                     entry("ATTEMPT=%zu", _recovery->attempts() + 1));
+
+    // The attributes kept open may have been replaced.
+    for (auto& [sensorSetKey, sensor] : _sensorObjects)
+    {
+        if (sensor->getInput() || sensor->getFault())
+        {
+            sensor->openInput();
+        }
+    }
+    return true;
+}
+
+void MainLoop::adapt(const SensorSet::key_type& sensorSetKey,
+                     InterfaceMap& obj, SensorValueType value)
+{
+    hwmon::Bounds bounds;
+    for (auto& [type, iface] : obj)
+    {
+        if (type == InterfaceType::WARN)
+        {
+            addBounds<WarningObject>(iface, bounds);
+        }
+        else if (type == InterfaceType::CRIT)
+        {
+            addBounds<CriticalObject>(iface, bounds);
+        }
+    }
+
+    // Sensors without thresholds keep their period.
+    if (bounds.lows.empty())
+    {
+        return;
+    }
+
+    // The host power throttle still overrides the adapted period.
+    _schedule.period(sensorSetKey,
+                     _adaptive->update(sensorSetKey, value,
+                                       hwmon::Adaptive::Clock::now(), bounds));
+}
+
+void MainLoop::trackLatency(const SensorSet::key_type& sensorSetKey,
+                            std::chrono::steady_clock::duration latency)
+{
+    using namespace std::chrono;
+
+    switch (_latency->record(sensorSetKey, latency))
+    {
+        case hwmon::LatencyTracker::Move::toAsync:
+            log<level::INFO>(
+                "Moving slow sensor to async reads",
+                entry("SENSOR=%s%s", sensorSetKey.first.c_str(),
+                      sensorSetKey.second.c_str()),
+                entry("EWMA_US=%lld",
+                      static_cast<long long>(
+                          duration_cast<microseconds>(
+                              _latency->ewma(sensorSetKey))
+                              .count())),
+                entry("P99_US=%lld",
+                      static_cast<long long>(
+                          duration_cast<microseconds>(
+                              _latency->p99(sensorSetKey))
+                              .count())),
+                entry("TIMEOUT_MS=%lld",
+                      static_cast<long long>(
+                          _latency->timeout(sensorSetKey)->count())));
+            break;
+        case hwmon::LatencyTracker::Move::toSync:
+            log<level::INFO>("Moving recovered sensor back to sync reads",
+                             entry("SENSOR=%s%s", sensorSetKey.first.c_str(),
+                                   sensorSetKey.second.c_str()));
+            break;
+        default:
+            break;
+    }
+}
+
+void MainLoop::removeSensors()
+{
+    // Remove any sensors marked for removal
+    for (const auto& i : _rmSensors)
+    {
+        if (_state.find(i.first) == _state.end())
+        {
+            // Never added, or already removed.
+            continue;
+        }
+
+        // Remove sensor object from dbus using emit_object_removed()
+        auto& objInfo = std::get<ObjectInfo>(_state[i.first]);
+        auto& objPath = std::get<std::string>(objInfo);
+
+        _bus.emit_object_removed(objPath.c_str());
+
+        // Erase sensor object info
+        _state.erase(i.first);
+    }
+}
+
+void MainLoop::addDroppedSensors()
+{
+    // Attempt to add any sensors that were removed
+    auto it = _rmSensors.begin();
+    while (it != _rmSensors.end())
+    {
+        if (_state.find(it->first) == _state.end())
+        {
+            SensorSet::container_t::value_type ssValueType =
+                std::make_pair(it->first, it->second);
+
+            auto object = getObject(ssValueType);
+            if (object)
+            {
+                // Construct the SensorSet value
+                // std::tuple<SensorSet::mapped_type,
+                //            std::string(Sensor Label),
+                //            ObjectInfo>
+                auto value = std::make_tuple(std::move(ssValueType.second),
+                                             std::move((*object).first),
+                                             std::move((*object).second));
+
+                _state[std::move(ssValueType.first)] = std::move(value);
+                if (_readByPage)
+                {
+                    setPage(it->first);
+                }
 
                 std::string input = hwmon::entry::input;
                 // If type is power and AVERAGE_power* is true in env, use
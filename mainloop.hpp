@@ -1,8 +1,25 @@
 #pragma once
 
+#include "adaptive.hpp"
+#include "alarm_watch.hpp"
 #include "average.hpp"
+#include "bus_lock.hpp"
+#include "control.hpp"
+#include "device_watch.hpp"
+#include "gpio_group.hpp"
 #include "hwmonio.hpp"
+#include "iio_buffer.hpp"
 #include "interface.hpp"
+#include "latency.hpp"
+#include "load_shed.hpp"
+#include "page_order.hpp"
+#include "period_monitor.hpp"
+#include "phase_timer.hpp"
+#include "power_state.hpp"
+#include "rate_control.hpp"
+#include "read_cycle.hpp"
+#include "recovery.hpp"
+#include "schedule.hpp"
 #include "sensor.hpp"
 #include "sensorset.hpp"
 #include "sysfs.hpp"
@@ -14,10 +31,13 @@
 #include <sdeventplus/utility/timer.hpp>
 
 #include <any>
+#include <chrono>
+#include <functional>
 #include <future>
 #include <memory>
 #include <optional>
 #include <string>
+#include <system_error>
 #include <vector>
 
 static constexpr auto default_interval = 1000000;
@@ -88,9 +108,171 @@ class MainLoop
         std::tuple<SensorSet::mapped_type, std::string, ObjectInfo>;
     using SensorState = std::map<SensorSet::key_type, mapped_type>;
 
-    /** @brief Read hwmon sysfs entries */
+    /** @brief Look up the PMBus page of a sensor for READ_ORDER=page.
+     *
+     *  @param[in] sensorSetKey - The sensor's identifiers.
+     */
+    void setPage(const SensorSet::key_type& sensorSetKey);
+
+    /** @brief Handle a tick of the read timer */
+    void tick();
+
+    /** @brief Arm the read timer for INTERVAL from now, with a fixed delay
+     *         between cycles */
+    void delay();
+
+    /** @brief Start a cycle reading all hwmon sysfs entries */
     void read();
 
+    /** @brief Read the next sensor of the current cycle.
+     *
+     *  @return - Whether any sensors are left to read in this cycle.
+     */
+    bool readNext();
+
+    /** @brief Try to take the bus lock, if sharing the bus, and count any
+     *         wait
+     *
+     *  @return - held if the bus can be used, waiting if it should be
+     *            tried again shortly, timedOut if it was waited for too
+     *            long.
+     */
+    hwmon::BusLock::State lockBus();
+
+    /** @brief Release the bus lock, if held */
+    void unlockBus();
+
+    /** @brief Track the latency of a sensor read, moving the sensor to or
+     *         from async reads as needed.
+     *
+     *  @param[in] sensorSetKey - The sensor read.
+     *  @param[in] latency - How long the read took.
+     */
+    void trackLatency(const SensorSet::key_type& sensorSetKey,
+                      std::chrono::steady_clock::duration latency);
+
+    /** @brief Count an overrun once a cycle is complete. */
+    void cycleComplete();
+
+    /** @brief Adapt a sensor's poll period to a new value.
+     *
+     *  @param[in] sensorSetKey - The sensor read.
+     *  @param[in] obj - The sensor's interfaces.
+     *  @param[in] value - The value read.
+     */
+    void adapt(const SensorSet::key_type& sensorSetKey, InterfaceMap& obj,
+               SensorValueType value);
+
+    /** @brief Read a single sensor and update its D-Bus interfaces.
+     *
+     *  @param[in] sensorSetKey - The sensor to read.
+     *  @param[in] sensorStateTuple - The sensor's object state.
+     */
+    void readSensor(const SensorSet::key_type& sensorSetKey,
+                    mapped_type& sensorStateTuple);
+
+    /** @brief Handle a failed sensor read.
+     *
+     *  Depending on the failure and the configuration the sensor is
+     *  marked non-functional, removed, or the daemon exits.
+     *
+     *  @param[in] sensorSetKey - The sensor read.
+     *  @param[in] sensorStateTuple - The sensor's object state.
+     *  @param[in] input - The attribute read.
+     *  @param[in] faultChecked - Whether the fault was read this cycle.
+     *  @param[in] ec - Why the read failed.
+     */
+    void readFailed(const SensorSet::key_type& sensorSetKey,
+                    mapped_type& sensorStateTuple, const std::string& input,
+                    bool faultChecked, const std::error_code& ec);
+
+    /** @brief Get the group reading the sensors gated by a GPIO.
+     *
+     *  @param[in] handle - The GPIO.
+     *
+     *  @return - The group, created on first use.
+     */
+    sensor::GpioGroup&
+        gpioGroup(const std::shared_ptr<gpioplus::HandleInterface>& handle);
+
+    /** @brief Stream the channels of an IIO device from its buffer */
+    void streamChannels();
+
+    /** @brief Throttle sensors in the host power domain while it's off */
+    void watchPowerState();
+
+    /** @brief Throttle or resume the host power domain sensors.
+     *
+     *  @param[in] on - Whether the host is on.
+     */
+    void powerChanged(bool on);
+
+    /** @brief Mark the values stale when quiesced and catch up on resume.
+     *
+     *  @param[in] quiesced - Whether reads and target writes are paused.
+     */
+    void quiesceChanged(bool quiesced);
+
+    /** @brief Whether reads and target writes are paused by Quiesce. */
+    bool quiesced() const;
+
+    /** @brief Report the instance quiesced once the async reads in flight
+     *         have finished, checking again until they have. */
+    void drain();
+
+    /** @brief Write out the fan targets held while quiesced or degraded. */
+    void releaseTargets();
+
+    /** @brief Mark the sensors non-functional while the device is
+     *         degraded. */
+    void markNonFunctional();
+
+    /** @brief Whether the device is degraded and not being tried again,
+     *         so is left alone until it is. */
+    bool awaitingRecovery() const;
+
+    /** @brief Try a degraded device again, once the backoff is over.
+     *
+     *  @return - Whether to read the device this cycle.
+     */
+    bool recover();
+
+    /** @brief Wait for the driver to be bound again if the device goes
+     *         away, rather than exiting */
+    void watchDevice();
+
+    /** @brief Follow the device's hwmon instance being removed and added.
+     *
+     *  @param[in] added - Whether the instance was added.
+     *  @param[in] instance - The instance (ex. hwmon3).
+     */
+    void deviceChanged(bool added, const std::string& instance);
+
+    /** @brief Stop reading the device until its instance is back */
+    void detach();
+
+    /** @brief Read the device through its new instance.
+     *
+     *  @param[in] instance - The instance (ex. hwmon3).
+     */
+    void attach(const std::string& instance);
+
+    /** @brief Whether any async reads that timed out are still running. */
+    bool readsInFlight() const;
+
+    /** @brief Free the accesses of previous instances once no async read
+     *         that timed out can still be using them. */
+    void releaseReboundIO();
+
+    /** @brief Watch the sensors' alarm and fault attributes for changes */
+    void watchAlarms();
+
+    /** @brief Read a sensor straight away when one of its alarms changes.
+     *
+     *  @param[in] sensorSetKey - The sensor.
+     */
+    void alarmed(const SensorSet::key_type& sensorSetKey);
+
     /** @brief Set up D-Bus object state */
     void init();
 
@@ -116,18 +298,109 @@ class MainLoop
     std::string _instanceId;
     /** @brief Sleep interval in microseconds. */
     uint64_t _interval = default_interval;
-    /** @brief Hwmon sysfs access. */
+    /** @brief Hwmon sysfs access, replaced when the driver is bound again. */
     const hwmonio::HwmonIOInterface* _ioAccess;
+    /** @brief Hwmon sysfs access of each instance since bound again */
+    std::vector<std::unique_ptr<hwmonio::HwmonIOInterface>> _reboundIO;
+    /** @brief Watches the instance go away and come back, if enabled */
+    std::unique_ptr<hwmon::DeviceWatch> _deviceWatch;
+    /** @brief Whether waiting for the instance to come back */
+    bool _detached = false;
     /** @brief the Event Loop structure */
     sdeventplus::Event _event;
     /** @brief Read Timer */
     sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> _timer;
+    /** @brief Read Timer on absolute deadlines, replaces _timer if set */
+    std::unique_ptr<hwmon::PhaseTimer> _phaseTimer;
+    /** @brief Whether _timer is rearmed once each cycle completes */
+    bool _fixedDelay = false;
+    /** @brief Missed ticks and jitter of the read timer */
+    std::unique_ptr<hwmon::PeriodMonitor> _period;
+    /** @brief Read cycle, sliced across event loop iterations */
+    hwmon::ReadCycle _cycle;
+    /** @brief Sensors to read in the current cycle */
+    std::vector<SensorSet::key_type> _cycleKeys;
+    /** @brief Index of the next sensor to read in _cycleKeys */
+    size_t _cycleNext = 0;
+    /** @brief When the current cycle started */
+    std::chrono::steady_clock::time_point _cycleStart;
+    /** @brief hwmonio::retryCount() when the current cycle started */
+    uint64_t _cycleRetries = 0;
+    /** @brief Failed reads in the current cycle */
+    uint64_t _cycleErrors = 0;
+    /** @brief Reads in the current cycle */
+    size_t _cycleReads = 0;
+    /** @brief Time spent reading in the current cycle */
+    std::chrono::steady_clock::duration _cycleBusy{0};
+    /** @brief Backs the poll rate off when the device struggles */
+    std::unique_ptr<hwmon::RateControl> _rateControl;
+    /** @brief Whether the current cycle ran out of time */
+    bool _cycleOverran = false;
+    /** @brief Sensors read per slot of a paced cycle, 0 if not paced */
+    size_t _paceBatch = 0;
+    /** @brief Whether to defer the reads of a cycle that runs out of time */
+    bool _shed = false;
+    /** @brief Time a cycle has to read its sensors when shedding, 0 for
+     *         the interval */
+    std::chrono::microseconds _cycleBudget{0};
+    /** @brief Priority order and reads deferred by overruns */
+    hwmon::LoadShed _loadShed;
+    /** @brief IIO buffer streaming the channel samples */
+    std::unique_ptr<iio::BufferStream> _stream;
+    /** @brief Picks the value published from the streamed samples */
+    std::function<double(const iio::Summary&)> _streamValue;
+    /** @brief Lock on the I2C bus shared with other processes, if enabled */
+    std::unique_ptr<hwmon::BusLock> _busLock;
+    /** @brief The longest to wait for the bus lock before skipping reads */
+    std::chrono::milliseconds _busLockTimeout{50};
+    /** @brief Quiesce and Resume methods for the instance */
+    std::unique_ptr<hwmon::Control> _control;
+    /** @brief Checks for the async reads in flight to finish when quiesced */
+    std::unique_ptr<
+        sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>
+        _drainTimer;
+    /** @brief Host power state, if any sensors are in its domain */
+    std::unique_ptr<hwmon::PowerState> _powerState;
+    /** @brief Sensors powered by the host */
+    std::vector<SensorSet::key_type> _hostSensors;
+    /** @brief Read interval of host sensors while it's off, 0 for never */
+    std::chrono::milliseconds _powerOffInterval{0};
+    /** @brief Poll periods adapted to the thresholds, if enabled */
+    std::unique_ptr<hwmon::Adaptive> _adaptive;
+    /** @brief Sensors read less often than every cycle */
+    hwmon::Schedule _schedule;
+    /** @brief Alarm and fault attributes watched for notifications */
+    std::vector<std::unique_ptr<hwmon::AlarmWatch>> _alarmWatches;
+    /** @brief Order to read sensors in to save PMBus page switches */
+    hwmon::PageOrder _pageOrder;
+    /** @brief Whether sensors are read page by page, READ_ORDER=page */
+    bool _readByPage = false;
+    /** @brief Sensors gated by a GPIO, grouped by the GPIO */
+    std::map<const gpioplus::HandleInterface*,
+             std::unique_ptr<sensor::GpioGroup>>
+        _gpioGroups;
+    /** @brief Time for GPIO gated sensors to settle after unlocking */
+    std::chrono::milliseconds _gpioSettle = sensor::gpioSettle;
+    /** @brief Time to leave a GPIO unlocked after reading its sensors */
+    std::chrono::milliseconds _gpioHold{0};
+    /** @brief How long a fault value is cached for */
+    std::chrono::milliseconds _faultRefresh{0};
+    /** @brief How long an average_interval value is cached for */
+    std::chrono::milliseconds _averageIntervalRefresh{0};
     /** @brief Store the specifications of sensor objects */
     std::map<SensorSet::key_type, std::unique_ptr<sensor::Sensor>>
         _sensorObjects;
+    /** @brief Recovers the device in place from failures, if enabled */
+    std::unique_ptr<hwmon::Recovery> _recovery;
+    /** @brief Read latencies, to move slow sensors to async reads */
+    std::unique_ptr<hwmon::LatencyTracker> _latency;
     /** @brief Store the async futures of timed out sensor objects */
     sensor::TimedoutMap _timedoutMap;
 
+    /** @brief Whether sensors that can't be read at startup are probed
+     *         again after each cycle, rather than exiting */
+    bool _partialStartup = false;
+
     /**
      * @brief Map of removed sensors
      */
@@ -166,5 +439,8 @@ class MainLoop
 
 /** @brief Given a value and map of interfaces, update values and check
  * thresholds.
+ *
+ * Doesn't allocate itself, the PropertiesChanged and alarm signals are
+ * built by sd-bus.
  */
 void updateSensorInterfaces(InterfaceMap& ifaces, SensorValueType value);
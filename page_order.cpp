@@ -0,0 +1,71 @@
+#include "page_order.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace hwmon
+{
+
+std::optional<int> pageFromLabel(const std::string& label)
+{
+    auto digits = std::find_if(label.rbegin(), label.rend(), [](char c) {
+                      return !std::isdigit(static_cast<unsigned char>(c));
+                  }).base();
+    if (digits == label.end() || digits == label.begin())
+    {
+        return std::nullopt;
+    }
+
+    auto number = std::atoi(&*digits);
+    if (number < 1)
+    {
+        return std::nullopt;
+    }
+
+    return number - 1;
+}
+
+int PageOrder::page(const SensorSet::key_type& sensor) const
+{
+    auto it = _pages.find(sensor);
+    return it == _pages.end() ? -1 : it->second;
+}
+
+void PageOrder::sort(std::vector<SensorSet::key_type>& sensors) const
+{
+    if (_pages.empty())
+    {
+        return;
+    }
+
+    std::stable_sort(sensors.begin(), sensors.end(),
+                     [this](const auto& a, const auto& b) {
+                         return page(a) < page(b);
+                     });
+}
+
+size_t PageOrder::switches(
+    const std::vector<SensorSet::key_type>& sensors) const
+{
+    size_t count = 0;
+    std::optional<int> current;
+
+    for (const auto& sensor : sensors)
+    {
+        auto p = page(sensor);
+        if (p < 0)
+        {
+            continue;
+        }
+        if (current && *current != p)
+        {
+            ++count;
+        }
+        current = p;
+    }
+
+    return count;
+}
+
+} // namespace hwmon
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "sensorset.hpp"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace hwmon
+{
+
+/** @brief Derive the PMBus page of a sensor from its label.
+ *
+ *  The pmbus driver suffixes the labels of paged sensors with the page
+ *  number plus one, ex. vout1 for page 0 and iout3 for page 2.
+ *
+ *  @param[in] label - The sensor's label attribute.
+ *
+ *  @return - The page, std::nullopt if the label has no page.
+ */
+std::optional<int> pageFromLabel(const std::string& label);
+
+/** @class PageOrder
+ *  @brief Orders reads to minimise PMBus page switches.
+ *  @details Reading an attribute on a multi-page PMBus device writes the
+ *  PAGE register first whenever the page differs from the last one read.
+ *  Sensors are read in key order by default, which alternates pages
+ *  constantly, so instead the reads are grouped page by page.
+ */
+class PageOrder
+{
+  public:
+    /** @brief Record the page a sensor is on.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *  @param[in] page - The sensor's page.
+     */
+    inline void set(const SensorSet::key_type& sensor, int page)
+    {
+        _pages[sensor] = page;
+    }
+
+    /** @brief Whether any pages are known. */
+    inline bool empty() const
+    {
+        return _pages.empty();
+    }
+
+    /** @brief Reorder sensors so those on the same page are adjacent.
+     *
+     *  Sensors without a known page are read first, otherwise the order
+     *  within a page is kept.
+     *
+     *  @param[in,out] sensors - The sensors to read.
+     */
+    void sort(std::vector<SensorSet::key_type>& sensors) const;
+
+    /** @brief Count the page switches reading sensors in order causes.
+     *
+     *  @param[in] sensors - The sensors to read.
+     *
+     *  @return - The number of times the page changes.
+     */
+    size_t switches(const std::vector<SensorSet::key_type>& sensors) const;
+
+  private:
+    /** @brief Get the page of a sensor, -1 if unknown. */
+    int page(const SensorSet::key_type& sensor) const;
+
+    /** @brief The page of each sensor. */
+    std::map<SensorSet::key_type, int> _pages;
+};
+
+} // namespace hwmon
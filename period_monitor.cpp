@@ -0,0 +1,35 @@
+#include "period_monitor.hpp"
+
+#include <cmath>
+
+namespace hwmon
+{
+
+uint64_t PeriodMonitor::tick(Clock::time_point now)
+{
+    uint64_t missed = 0;
+
+    if (_since != Clock::time_point{} && _interval.count() > 0)
+    {
+        auto elapsed = now - _since;
+        auto ticks = (elapsed + _interval / 2) / _interval;
+        if (ticks > 1)
+        {
+            missed = ticks - 1;
+        }
+
+        auto error = std::chrono::duration<double>(elapsed - ticks * _interval);
+        _jitter += (std::abs(error.count()) - _jitter) / 16;
+    }
+
+    _since = now;
+    return missed;
+}
+
+PeriodMonitor::Clock::duration PeriodMonitor::jitter() const
+{
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(_jitter));
+}
+
+} // namespace hwmon
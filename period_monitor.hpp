@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace hwmon
+{
+
+/** @class PeriodMonitor
+ *  @brief Measures how far the poll timer strays from its period.
+ *  @details The time from the start of each wait to the tick ending it is
+ *  rounded to a whole number of intervals.  More than one interval means
+ *  ticks were missed, and the remainder is the tick's error.  The jitter
+ *  is a running mean of the error, as for RTP interarrival jitter in
+ *  RFC 3550.  A wait normally starts at the previous tick, or later with
+ *  a fixed delay between the end of a cycle and the next tick.
+ */
+class PeriodMonitor
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    PeriodMonitor() = delete;
+
+    /** @brief Constructor
+     *
+     *  @param[in] interval - The period the timer is set to.
+     */
+    explicit PeriodMonitor(Clock::duration interval) : _interval(interval) {}
+
+    /** @brief Record a tick.
+     *
+     *  @param[in] now - When the tick fired.
+     *
+     *  @return - The number of ticks missed since the previous one.
+     */
+    uint64_t tick(Clock::time_point now);
+
+    /** @brief Start waiting for the next tick later than the last one.
+     *
+     *  @param[in] now - When the wait started.
+     */
+    inline void wait(Clock::time_point now)
+    {
+        _since = now;
+    }
+
+    /** @brief The running mean error of the ticks. */
+    Clock::duration jitter() const;
+
+  private:
+    /** @brief The period the timer is set to. */
+    Clock::duration _interval;
+    /** @brief When the current wait started, unset before the first. */
+    Clock::time_point _since{};
+    /** @brief The jitter, in seconds. */
+    double _jitter = 0;
+};
+
+} // namespace hwmon
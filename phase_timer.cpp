@@ -0,0 +1,52 @@
+#include "phase_timer.hpp"
+
+#include <sdeventplus/source/base.hpp>
+
+namespace hwmon
+{
+
+std::chrono::microseconds nextDeadline(std::chrono::microseconds now,
+                                       std::chrono::microseconds base,
+                                       std::chrono::microseconds interval)
+{
+    if (now < base)
+    {
+        // Step back to the last deadline before now.
+        base -= ((base - now) / interval + 1) * interval;
+    }
+
+    return base + ((now - base) / interval + 1) * interval;
+}
+
+PhaseTimer::PhaseTimer(const sdeventplus::Event& event,
+                       std::chrono::microseconds interval, bool aligned,
+                       std::chrono::microseconds offset,
+                       std::chrono::microseconds accuracy,
+                       Callback&& callback) :
+    _interval(interval), _base(offset), _callback(std::move(callback)),
+    _source(event, Clock::time_point(), accuracy,
+            [this](auto&, auto) {
+                arm();
+                _callback();
+            })
+{
+    if (!aligned)
+    {
+        // Start the deadlines from now instead.
+        _base += std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock(event).now().time_since_epoch());
+    }
+    arm();
+}
+
+void PhaseTimer::arm()
+{
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock(_source.get_event()).now().time_since_epoch());
+    _source.set_time(
+        Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+            nextDeadline(now, _base, _interval))));
+    _source.set_enabled(sdeventplus::source::Enabled::OneShot);
+}
+
+} // namespace hwmon
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/time.hpp>
+
+#include <chrono>
+#include <functional>
+
+namespace hwmon
+{
+
+/** @brief Get the first deadline after a point in time.
+ *
+ *  Deadlines fall every interval, starting from the base.
+ *
+ *  @param[in] now - The current time.
+ *  @param[in] base - A deadline.
+ *  @param[in] interval - The time between deadlines.
+ *
+ *  @return - The first deadline after now.
+ */
+std::chrono::microseconds nextDeadline(std::chrono::microseconds now,
+                                       std::chrono::microseconds base,
+                                       std::chrono::microseconds interval);
+
+/** @class PhaseTimer
+ *  @brief Periodic timer firing at absolute CLOCK_MONOTONIC deadlines.
+ *  @details Unlike sdeventplus::utility::Timer the next expiry isn't
+ *  measured from when the callback ran, so the timer doesn't drift, and a
+ *  late expiry skips the deadlines it missed rather than firing for each.
+ *  Aligned timers put their deadlines at multiples of the interval since
+ *  the clock's epoch, plus an offset, so every process using the same
+ *  interval wakes up at the same time or at a fixed stagger from the
+ *  others.  The accuracy lets the kernel merge the wakeups with others.
+ */
+class PhaseTimer
+{
+  public:
+    using Clock = sdeventplus::Clock<sdeventplus::ClockId::Monotonic>;
+    /** @brief Called on each expiry. */
+    using Callback = std::function<void()>;
+
+    PhaseTimer() = delete;
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+    PhaseTimer(PhaseTimer&&) = delete;
+    PhaseTimer& operator=(PhaseTimer&&) = delete;
+    ~PhaseTimer() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - The event loop to run on.
+     *  @param[in] interval - The time between expiries.
+     *  @param[in] aligned - Whether to align the deadlines to the clock's
+     *                       epoch rather than to now.
+     *  @param[in] offset - Offset of the deadlines from the alignment.
+     *  @param[in] accuracy - How late an expiry may be, to coalesce it.
+     *  @param[in] callback - Called on each expiry.
+     */
+    PhaseTimer(const sdeventplus::Event& event,
+               std::chrono::microseconds interval, bool aligned,
+               std::chrono::microseconds offset,
+               std::chrono::microseconds accuracy, Callback&& callback);
+
+  private:
+    /** @brief Arm the timer for the next deadline after now. */
+    void arm();
+
+    /** @brief The time between expiries. */
+    std::chrono::microseconds _interval;
+    /** @brief A deadline, the others are multiples of interval from it. */
+    std::chrono::microseconds _base;
+    /** @brief Called on each expiry. */
+    Callback _callback;
+    /** @brief The underlying time source. */
+    sdeventplus::source::Time<sdeventplus::ClockId::Monotonic> _source;
+};
+
+} // namespace hwmon
@@ -0,0 +1,71 @@
+#include "power_state.hpp"
+
+#include <map>
+#include <variant>
+
+namespace hwmon
+{
+
+PowerState::PowerState(sdbusplus::bus_t& bus, Callback&& callback) :
+    _callback(std::move(callback)),
+    _match(bus,
+           sdbusplus::bus::match::rules::propertiesChanged(path, interface),
+           [this](sdbusplus::message_t& msg) {
+               std::string iface;
+               std::map<std::string, std::variant<std::string>> properties;
+               msg.read(iface, properties);
+
+               auto it = properties.find(property);
+               if (it != properties.end())
+               {
+                   update(std::get<std::string>(it->second));
+               }
+           })
+{
+    try
+    {
+        auto method = bus.new_method_call(service, path,
+                                          "org.freedesktop.DBus.Properties",
+                                          "Get");
+        method.append(interface, property);
+        auto reply = bus.call(method);
+
+        std::variant<std::string> state;
+        reply.read(state);
+        update(std::get<std::string>(state));
+    }
+    catch (const std::exception&)
+    {
+        // Not running yet, the match picks up the state once it is.
+    }
+}
+
+std::optional<bool> PowerState::isOn(const std::string& state)
+{
+    static constexpr auto prefix = "xyz.openbmc_project.State.Chassis."
+                                   "PowerState.";
+
+    if (state == std::string(prefix) + "On")
+    {
+        return true;
+    }
+    if (state == std::string(prefix) + "Off")
+    {
+        return false;
+    }
+    return std::nullopt;
+}
+
+void PowerState::update(const std::string& state)
+{
+    auto on = isOn(state);
+    if (!on || *on == _on)
+    {
+        return;
+    }
+
+    _on = *on;
+    _callback(_on);
+}
+
+} // namespace hwmon
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace hwmon
+{
+
+/** @class PowerState
+ *  @brief Follows whether the host is powered on.
+ *  @details The chassis CurrentPowerState property is read at startup and
+ *  then watched for changes.  If it can't be read the host is assumed to
+ *  be on, so sensors aren't throttled by mistake.
+ */
+class PowerState
+{
+  public:
+    /** @brief Called with the new state when it changes. */
+    using Callback = std::function<void(bool)>;
+
+    static constexpr auto service = "xyz.openbmc_project.State.Chassis";
+    static constexpr auto path = "/xyz/openbmc_project/state/chassis0";
+    static constexpr auto interface = "xyz.openbmc_project.State.Chassis";
+    static constexpr auto property = "CurrentPowerState";
+
+    PowerState() = delete;
+    PowerState(const PowerState&) = delete;
+    PowerState& operator=(const PowerState&) = delete;
+    PowerState(PowerState&&) = delete;
+    PowerState& operator=(PowerState&&) = delete;
+    ~PowerState() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] bus - The bus to watch the power state on.
+     *  @param[in] callback - Called when the state changes.
+     */
+    PowerState(sdbusplus::bus_t& bus, Callback&& callback);
+
+    /** @brief Whether the host is on. */
+    inline bool on() const
+    {
+        return _on;
+    }
+
+    /** @brief Whether a CurrentPowerState value means the host is on.
+     *
+     *  @param[in] state - The property value.
+     *
+     *  @return - Whether it is on, std::nullopt if the value is unknown.
+     */
+    static std::optional<bool> isOn(const std::string& state);
+
+  private:
+    /** @brief Handle a new property value. */
+    void update(const std::string& state);
+
+    /** @brief Called when the state changes. */
+    Callback _callback;
+    /** @brief The current state. */
+    bool _on = true;
+    /** @brief Watches for changes to the property. */
+    sdbusplus::bus::match_t _match;
+};
+
+} // namespace hwmon
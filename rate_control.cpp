@@ -0,0 +1,53 @@
+#include "rate_control.hpp"
+
+#include <algorithm>
+
+namespace hwmon
+{
+
+namespace
+{
+
+/** @brief Polls per second at an interval. */
+double rateOf(RateControl::Clock::duration interval)
+{
+    return 1 / std::chrono::duration<double>(interval).count();
+}
+
+} // namespace
+
+RateControl::RateControl(Clock::duration min, Clock::duration max,
+                         double spike) :
+    _maxRate(rateOf(min)), _minRate(rateOf(std::max(min, max))),
+    _rate(_maxRate), _spike(spike)
+{}
+
+bool RateControl::cycle(uint64_t errors, Clock::duration latency)
+{
+    auto seconds = std::chrono::duration<double>(latency).count();
+    auto rate = _rate;
+
+    if (errors > 0 || (_latency && seconds > _spike * *_latency))
+    {
+        rate = std::max(_rate / 2, _minRate);
+    }
+    else
+    {
+        // Only learn the usual latency from clean cycles, so a slow device
+        // doesn't make its slowness the norm.
+        _latency = _latency ? (*_latency * 7 + seconds) / 8 : seconds;
+        rate = std::min(_rate + _maxRate / recoveryCycles, _maxRate);
+    }
+
+    auto changed = rate != _rate;
+    _rate = rate;
+    return changed;
+}
+
+RateControl::Clock::duration RateControl::interval() const
+{
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1 / _rate));
+}
+
+} // namespace hwmon
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace hwmon
+{
+
+/** @class RateControl
+ *  @brief AIMD congestion control of the poll rate of a device.
+ *  @details After each cycle with errors, or with a read latency over a
+ *  multiple of its usual latency, the poll rate is halved.  After each
+ *  clean cycle it recovers by a tenth of the full rate, so a device that
+ *  has settled down is back to full rate within ten cycles.  The rate
+ *  stays between the full rate and the minimum rate.  The usual latency
+ *  is a moving average over the clean cycles.
+ */
+class RateControl
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Number of clean cycles to recover from the minimum rate. */
+    static constexpr auto recoveryCycles = 10;
+
+    RateControl() = delete;
+
+    /** @brief Constructor
+     *
+     *  @param[in] min - The poll interval at the full rate.
+     *  @param[in] max - The poll interval at the minimum rate.
+     *  @param[in] spike - The multiple of the usual latency that counts as
+     *                     a spike.
+     */
+    RateControl(Clock::duration min, Clock::duration max, double spike);
+
+    /** @brief Adjust the rate after a cycle.
+     *
+     *  @param[in] errors - Errors and retries during the cycle.
+     *  @param[in] latency - Mean read latency during the cycle.
+     *
+     *  @return - Whether the interval changed.
+     */
+    bool cycle(uint64_t errors, Clock::duration latency);
+
+    /** @brief The current poll interval. */
+    Clock::duration interval() const;
+
+  private:
+    /** @brief The full rate, in polls per second. */
+    double _maxRate;
+    /** @brief The minimum rate, in polls per second. */
+    double _minRate;
+    /** @brief The current rate, in polls per second. */
+    double _rate;
+    /** @brief The multiple of the usual latency that counts as a spike. */
+    double _spike;
+    /** @brief The usual latency, in seconds. */
+    std::optional<double> _latency;
+};
+
+} // namespace hwmon
@@ -0,0 +1,116 @@
+#include "read_cycle.hpp"
+
+#include <sdeventplus/source/base.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace hwmon
+{
+
+ReadCycle::ReadCycle(const sdeventplus::Event& event, Step&& step,
+                     Complete&& complete) :
+    _step(std::move(step)), _complete(std::move(complete)),
+    _resume(event, [this](sdeventplus::source::EventBase&) { slice(); }),
+    _slotTimer(event, [this](auto&) {
+        if (_slot.count() > 0)
+        {
+            paced();
+        }
+        else
+        {
+            slice();
+        }
+    })
+{
+    // Let everything else that is pending run before resuming a cycle.
+    _resume.set_priority(SD_EVENT_PRIORITY_IDLE);
+    _resume.set_enabled(sdeventplus::source::Enabled::Off);
+}
+
+bool ReadCycle::start()
+{
+    if (_running)
+    {
+        return false;
+    }
+
+    _running = true;
+    _wait.reset();
+    if (_slot.count() > 0)
+    {
+        _nextSlot = std::chrono::steady_clock::now();
+        _batchLeft = _batch;
+        paced();
+    }
+    else
+    {
+        slice();
+    }
+    return true;
+}
+
+void ReadCycle::slice()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    while (_step())
+    {
+        if (_wait)
+        {
+            // Come back once the wait is over rather than blocking.
+            _slotTimer.restartOnce(*std::exchange(_wait, std::nullopt));
+            return;
+        }
+
+        if (_budget.count() > 0 &&
+            std::chrono::steady_clock::now() - start >= _budget)
+        {
+            // Out of time, pick up where we left off on a later
+            // iteration of the event loop.
+            _resume.set_enabled(sdeventplus::source::Enabled::OneShot);
+            if (_yield)
+            {
+                _yield();
+            }
+            return;
+        }
+    }
+
+    _running = false;
+    _complete();
+}
+
+void ReadCycle::paced()
+{
+    for (; _batchLeft > 0; --_batchLeft)
+    {
+        if (!_step())
+        {
+            _running = false;
+            _complete();
+            return;
+        }
+
+        if (_wait)
+        {
+            // The step is run again after the wait, still in this slot.
+            _slotTimer.restartOnce(*std::exchange(_wait, std::nullopt));
+            return;
+        }
+    }
+    _batchLeft = _batch;
+
+    // Slots are kept a fixed time from the start of the cycle, so a late
+    // batch doesn't push the rest of the cycle back.
+    _nextSlot += _slot;
+    auto wait = std::chrono::duration_cast<std::chrono::microseconds>(
+        _nextSlot - std::chrono::steady_clock::now());
+    _slotTimer.restartOnce(std::max(wait, std::chrono::microseconds(0)));
+    if (_yield)
+    {
+        _yield();
+    }
+}
+
+} // namespace hwmon
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+namespace hwmon
+{
+
+/** @class ReadCycle
+ *  @brief Runs a sensor read cycle in slices on the sd-event loop.
+ *  @details Each slice calls the step function until it reports that no
+ *  work remains or until the configured budget has been used up.  When the
+ *  budget runs out the cycle yields back to the event loop and resumes from
+ *  an idle priority deferred source, so any pending D-Bus requests are
+ *  dispatched in between slices.  A budget of zero runs the whole cycle to
+ *  completion in one go.
+ *
+ *  Alternatively a cycle can be paced, running a batch of steps per slot
+ *  with the slots a fixed time apart, to spread the reads evenly across
+ *  the interval instead of issuing them in a burst.
+ *
+ *  A step that has to wait for something, such as a lock, asks the cycle
+ *  to wait rather than blocking the event loop.
+ */
+class ReadCycle
+{
+  public:
+    /** @brief Read the next item, returns false once the cycle is done. */
+    using Step = std::function<bool()>;
+    /** @brief Called once after the last step of a cycle. */
+    using Complete = std::function<void()>;
+    /** @brief Called when a cycle yields to the event loop. */
+    using Yield = std::function<void()>;
+
+    ReadCycle() = delete;
+    ReadCycle(const ReadCycle&) = delete;
+    ReadCycle& operator=(const ReadCycle&) = delete;
+    ReadCycle(ReadCycle&&) = delete;
+    ReadCycle& operator=(ReadCycle&&) = delete;
+    ~ReadCycle() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - The event loop to yield to.
+     *  @param[in] step - Reads the next item of the cycle.
+     *  @param[in] complete - Called when a cycle has finished.
+     */
+    ReadCycle(const sdeventplus::Event& event, Step&& step,
+              Complete&& complete);
+
+    /** @brief Start a new cycle.
+     *
+     *  @return false if the previous cycle is still in progress.
+     */
+    bool start();
+
+    /** @brief Whether a cycle is currently in progress. */
+    inline bool running() const
+    {
+        return _running;
+    }
+
+    /** @brief Set the time budget of a single slice.
+     *
+     *  @param[in] budget - The budget, zero to disable slicing.
+     */
+    inline void budget(std::chrono::microseconds budget)
+    {
+        _budget = budget;
+    }
+
+    /** @brief Get the time budget of a single slice. */
+    inline std::chrono::microseconds budget() const
+    {
+        return _budget;
+    }
+
+    /** @brief Pace the steps of the following cycles.
+     *
+     *  @param[in] slot - Time between batches, zero to disable pacing.
+     *  @param[in] batch - Steps to run per slot.
+     */
+    inline void pace(std::chrono::microseconds slot, size_t batch)
+    {
+        _slot = slot;
+        _batch = batch;
+    }
+
+    /** @brief Have the cycle wait before running the step again.
+     *
+     *  Called from a step that can't make progress yet, which then returns
+     *  true without having done its work.  The cycle goes back to the
+     *  event loop and runs the step again once the delay has passed.
+     *
+     *  @param[in] delay - How long to wait.
+     */
+    inline void wait(std::chrono::microseconds delay)
+    {
+        _wait = delay;
+    }
+
+    /** @brief Set a callback for when a cycle yields to the event loop.
+     *
+     *  @param[in] yield - Called each time a cycle yields.
+     */
+    inline void onYield(Yield&& yield)
+    {
+        _yield = std::move(yield);
+    }
+
+  private:
+    /** @brief Run steps until done or the budget is exhausted. */
+    void slice();
+
+    /** @brief Run a batch of steps and wait for the next slot. */
+    void paced();
+
+    /** @brief Reads the next item. */
+    Step _step;
+    /** @brief Cycle completion callback. */
+    Complete _complete;
+    /** @brief Cycle yield callback. */
+    Yield _yield;
+    /** @brief Per slice time budget. */
+    std::chrono::microseconds _budget{0};
+    /** @brief Time between paced batches, zero if not paced. */
+    std::chrono::microseconds _slot{0};
+    /** @brief Steps per paced batch. */
+    size_t _batch = 1;
+    /** @brief Steps left to run in the current paced batch. */
+    size_t _batchLeft = 1;
+    /** @brief Delay asked for by the last step, if any. */
+    std::optional<std::chrono::microseconds> _wait;
+    /** @brief When the next paced batch is due. */
+    std::chrono::steady_clock::time_point _nextSlot;
+    /** @brief Whether a cycle is in progress. */
+    bool _running = false;
+    /** @brief Deferred source used to resume the cycle. */
+    sdeventplus::source::Defer _resume;
+    /** @brief Timer used to resume a paced or waiting cycle. */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> _slotTimer;
+};
+
+} // namespace hwmon
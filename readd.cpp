@@ -16,6 +16,7 @@
 #include "config.h"
 
 #include "hwmonio.hpp"
+#include "iio.hpp"
 #include "mainloop.hpp"
 #include "sysfs.hpp"
 
@@ -73,7 +74,13 @@ int main(int argc, char** argv)
             // When disabled, use the original logic based on path format
             if (devpath.starts_with("/devices"))
             {
-                path = sysfs::findHwmonFromDevPath(devpath);
+                // IIO devices are read directly rather than through an
+                // iio-hwmon instance.
+                path = iio::findDeviceFromDevPath(devpath);
+                if (path.empty())
+                {
+                    path = sysfs::findHwmonFromDevPath(devpath);
+                }
                 if (path.empty())
                 {
                     exit_with_error(
@@ -106,16 +113,26 @@ int main(int argc, char** argv)
     }
 
     // Determine the physical device sysfs path.
-    auto calloutPath = sysfs::findCalloutPath(path);
+    auto isIio = iio::isDevice(path);
+    auto calloutPath = isIio ? iio::findCalloutPath(path)
+                             : sysfs::findCalloutPath(path);
     if (calloutPath.empty())
     {
         exit_with_error(app.help("", CLI::AppFormatMode::All),
                         "Unable to determine callout path.");
     }
 
-    hwmonio::HwmonIO io(path);
+    std::unique_ptr<hwmonio::HwmonIOInterface> io;
+    if (isIio)
+    {
+        io = std::make_unique<iio::IioIO>(path);
+    }
+    else
+    {
+        io = std::make_unique<hwmonio::HwmonIO>(path);
+    }
     MainLoop loop(sdbusplus::bus::new_default(), param, path, calloutPath,
-                  BUSNAME_PREFIX, SENSOR_ROOT, sensor_id, &io);
+                  BUSNAME_PREFIX, SENSOR_ROOT, sensor_id, io.get());
     loop.run();
 
     return 0;
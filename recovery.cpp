@@ -0,0 +1,125 @@
+#include "recovery.hpp"
+
+#include <phosphor-logging/log.hpp>
+
+#include <algorithm>
+
+namespace hwmon
+{
+
+namespace
+{
+
+/** @brief The device's recovery. */
+Recovery* current = nullptr;
+
+} // namespace
+
+Recovery* recovery()
+{
+    return current;
+}
+
+bool degraded()
+{
+    return current && current->state() == Recovery::State::degraded;
+}
+
+bool degrade(const std::string& devPath)
+{
+    using namespace phosphor::logging;
+
+    if (!current)
+    {
+        return false;
+    }
+
+    auto healthy = current->state() == Recovery::State::healthy;
+    auto state = current->fail(Recovery::Clock::now());
+    if (state == Recovery::State::failed)
+    {
+        log<level::ERR>("Device did not recover",
+                        entry("DEVICE=%s", devPath.c_str()),
+                        entry("ATTEMPTS=%zu", current->attempts()));
+        return false;
+    }
+
+    if (healthy)
+    {
+        log<level::ERR>("Device degraded, recovering",
+                        entry("DEVICE=%s", devPath.c_str()));
+    }
+    return true;
+}
+
+Recovery::Recovery(Clock::duration backoff, Clock::duration maxBackoff,
+                   size_t budget) :
+    _minBackoff(backoff), _maxBackoff(std::max(backoff, maxBackoff)),
+    _budget(budget)
+{
+    current = this;
+}
+
+Recovery::~Recovery()
+{
+    if (current == this)
+    {
+        current = nullptr;
+    }
+}
+
+Recovery::State Recovery::fail(Clock::time_point now)
+{
+    if (_state == State::healthy)
+    {
+        _state = State::degraded;
+        _attempts = 0;
+        _backoff = _minBackoff;
+        _next = now + _backoff;
+        if (_onDegrade)
+        {
+            _onDegrade();
+        }
+    }
+    else if (_state == State::degraded && _attempting)
+    {
+        _attempting = false;
+        if (++_attempts >= _budget)
+        {
+            _state = State::failed;
+        }
+        else
+        {
+            _backoff = std::min(_backoff * 2, _maxBackoff);
+            _next = now + _backoff;
+        }
+    }
+
+    return _state;
+}
+
+bool Recovery::attempt(Clock::time_point now)
+{
+    if (_state != State::degraded || _attempting || now < _next)
+    {
+        return false;
+    }
+
+    _attempting = true;
+    return true;
+}
+
+bool Recovery::finish()
+{
+    if (!_attempting)
+    {
+        return false;
+    }
+
+    _attempting = false;
+    _state = State::healthy;
+    _attempts = 0;
+    return true;
+}
+
+} // namespace hwmon
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace hwmon
+{
+
+/** @class Recovery
+ *  @brief Recovers a failing device in place rather than exiting.
+ *  @details A read or write failure that would otherwise exit marks the
+ *  device degraded.  While degraded the sensors keep their last values,
+ *  marked non-functional, and the device is tried again after a backoff
+ *  that doubles after each failed attempt, up to a maximum.  An attempt
+ *  without failures recovers the device.  Once the budget of attempts is
+ *  spent the device has failed, and the caller exits as it used to.
+ */
+class Recovery
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    /** @brief Called when the device degrades. */
+    using Degrade = std::function<void()>;
+
+    /** @brief The state of the device. */
+    enum class State
+    {
+        healthy,
+        degraded,
+        failed,
+    };
+
+    Recovery() = delete;
+    Recovery(const Recovery&) = delete;
+    Recovery& operator=(const Recovery&) = delete;
+    Recovery(Recovery&&) = delete;
+    Recovery& operator=(Recovery&&) = delete;
+    ~Recovery();
+
+    /** @brief Constructor
+     *
+     *  The device's recovery until destroyed, see recovery().
+     *
+     *  @param[in] backoff - The wait before the first attempt.
+     *  @param[in] maxBackoff - The longest wait between attempts.
+     *  @param[in] budget - The failed attempts before giving up.
+     */
+    Recovery(Clock::duration backoff, Clock::duration maxBackoff,
+             size_t budget);
+
+    /** @brief Set a callback for when a healthy device degrades.
+     *
+     *  @param[in] callback - Called from fail().
+     */
+    inline void onDegrade(Degrade&& callback)
+    {
+        _onDegrade = std::move(callback);
+    }
+
+    /** @brief Record a failure.
+     *
+     *  Degrades a healthy device, and fails an attempt in progress.
+     *  Failures while waiting to attempt again are already accounted for.
+     *
+     *  @param[in] now - The current time.
+     *
+     *  @return - The new state.
+     */
+    State fail(Clock::time_point now);
+
+    /** @brief Start an attempt to recover, if one is due.
+     *
+     *  @param[in] now - The current time.
+     *
+     *  @return - Whether to try the device again.
+     */
+    bool attempt(Clock::time_point now);
+
+    /** @brief Finish an attempt.
+     *
+     *  @return - Whether the device recovered, the attempt having had no
+     *            failures.
+     */
+    bool finish();
+
+    /** @brief The state of the device. */
+    inline State state() const
+    {
+        return _state;
+    }
+
+    /** @brief Whether an attempt is in progress. */
+    inline bool attempting() const
+    {
+        return _attempting;
+    }
+
+    /** @brief The failed attempts since the device degraded. */
+    inline size_t attempts() const
+    {
+        return _attempts;
+    }
+
+  private:
+    /** @brief The wait before the first attempt. */
+    Clock::duration _minBackoff;
+    /** @brief The longest wait between attempts. */
+    Clock::duration _maxBackoff;
+    /** @brief The failed attempts before giving up. */
+    size_t _budget;
+    /** @brief The state of the device. */
+    State _state = State::healthy;
+    /** @brief The current wait between attempts. */
+    Clock::duration _backoff{0};
+    /** @brief When the next attempt is due. */
+    Clock::time_point _next;
+    /** @brief The failed attempts since the device degraded. */
+    size_t _attempts = 0;
+    /** @brief Whether an attempt is in progress. */
+    bool _attempting = false;
+    /** @brief Called when the device degrades. */
+    Degrade _onDegrade;
+};
+
+/** @brief The device's recovery, nullptr if failures exit.
+ *
+ *  For fan targets, which are written outside of the read cycle.
+ */
+Recovery* recovery();
+
+/** @brief Whether the device is degraded, with writes to it held. */
+bool degraded();
+
+/** @brief Degrade the device after a failure, if it can be recovered,
+ *         logging the change of state.
+ *
+ *  @param[in] devPath - The /sys/devices sysfs path, for the log.
+ *
+ *  @return - Whether the device is being recovered, false if failures
+ *            exit or it has run out of attempts.
+ */
+bool degrade(const std::string& devPath);
+
+} // namespace hwmon
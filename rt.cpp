@@ -0,0 +1,145 @@
+#include "rt.hpp"
+
+#include "env.hpp"
+
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <charconv>
+#include <system_error>
+
+namespace rt
+{
+
+bool enabled()
+{
+    static const bool enabled = env::getEnv("RT_MODE") == "true";
+    return enabled;
+}
+
+void setup()
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    // Keep page faults off the fan control and tach read paths.
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        lg2::error("Unable to lock memory: {ERRNO}", "ERRNO", errno);
+    }
+
+    auto priority = env::getEnv("RT_PRIORITY");
+    if (!priority.empty())
+    {
+        sched_param param{};
+        auto [ptr, ec] = std::from_chars(
+            priority.data(), priority.data() + priority.size(),
+            param.sched_priority);
+        if (ec != std::errc() ||
+            sched_setscheduler(0, SCHED_FIFO, &param) != 0)
+        {
+            lg2::error("Unable to set SCHED_FIFO priority {PRIORITY}: "
+                       "{ERRNO}",
+                       "PRIORITY", priority, "ERRNO", errno);
+        }
+    }
+
+    auto cpuList = env::getEnv("RT_CPUS");
+    if (!cpuList.empty())
+    {
+        auto cpus = parseCpuList(cpuList);
+        if (!cpus)
+        {
+            lg2::error("Invalid RT_CPUS: {CPUS}", "CPUS", cpuList);
+            return;
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto cpu : *cpus)
+        {
+            CPU_SET(cpu, &set);
+        }
+
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        {
+            lg2::error("Unable to set CPU affinity {CPUS}: {ERRNO}", "CPUS",
+                       cpuList, "ERRNO", errno);
+        }
+    }
+}
+
+std::optional<std::vector<int>> parseCpuList(std::string_view list)
+{
+    std::vector<int> cpus;
+
+    while (!list.empty())
+    {
+        auto comma = list.find(',');
+        auto item = list.substr(0, comma);
+        list = (comma == std::string_view::npos) ? std::string_view{}
+                                                 : list.substr(comma + 1);
+
+        int first = 0;
+        auto [ptr, ec] =
+            std::from_chars(item.data(), item.data() + item.size(), first);
+        if (ec != std::errc())
+        {
+            return std::nullopt;
+        }
+
+        int last = first;
+        if (ptr != item.data() + item.size())
+        {
+            if (*ptr != '-')
+            {
+                return std::nullopt;
+            }
+            auto [end, rec] =
+                std::from_chars(ptr + 1, item.data() + item.size(), last);
+            if (rec != std::errc() || end != item.data() + item.size())
+            {
+                return std::nullopt;
+            }
+        }
+
+        if (first < 0 || last < first || last >= CPU_SETSIZE)
+        {
+            return std::nullopt;
+        }
+
+        for (auto cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
+std::optional<hwmonio::Attribute> openAttribute(const std::string& path)
+{
+    if (!enabled())
+    {
+        return std::nullopt;
+    }
+
+    try
+    {
+        return hwmonio::Attribute(path);
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Unable to open {PATH} for real-time IO: {ERR}", "PATH",
+                   path, "ERR", e.code().value());
+    }
+
+    return std::nullopt;
+}
+
+} // namespace rt
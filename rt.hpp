@@ -0,0 +1,46 @@
+#pragma once
+
+#include "hwmonio.hpp"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rt
+{
+
+/** @brief Whether real-time mode is enabled
+ *
+ *  Real-time mode is opted into with RT_MODE=true in the env.
+ *
+ *  @return - true if enabled
+ */
+bool enabled();
+
+/** @brief Apply the real-time process settings
+ *
+ *  Locks all current and future memory, then applies the SCHED_FIFO
+ *  priority from RT_PRIORITY and the CPU affinity from RT_CPUS.  Failures
+ *  are logged and otherwise ignored.  Does nothing unless enabled().
+ */
+void setup();
+
+/** @brief Parse a list of CPUs
+ *
+ *  @param[in] list - Comma separated CPUs or ranges, e.g. "0,2-3".
+ *
+ *  @return - The CPUs, nothing if the list is invalid.
+ */
+std::optional<std::vector<int>> parseCpuList(std::string_view list);
+
+/** @brief Open an attribute up front for allocation free IO
+ *
+ *  @param[in] path - Full path of the sysfs attribute.
+ *
+ *  @return - The open attribute, nothing if not enabled() or the
+ *            attribute couldn't be opened.
+ */
+std::optional<hwmonio::Attribute> openAttribute(const std::string& path);
+
+} // namespace rt
@@ -0,0 +1,110 @@
+#include "schedule.hpp"
+
+namespace hwmon
+{
+
+void Schedule::period(const SensorSet::key_type& sensor,
+                      Clock::duration period)
+{
+    if (period.count() < 0)
+    {
+        period = Clock::duration{0};
+    }
+
+    auto it = _entries.find(sensor);
+    if (it == _entries.end())
+    {
+        if (period.count() > 0)
+        {
+            _entries[sensor].period = period;
+        }
+        return;
+    }
+
+    auto& entry = it->second;
+    if (entry.next && !entry.throttle && entry.period != period)
+    {
+        // Apply the new period from the last read.
+        *entry.next += period - entry.period;
+    }
+    entry.period = period;
+
+    if (period.count() == 0 && !entry.throttle)
+    {
+        _entries.erase(it);
+    }
+}
+
+void Schedule::throttle(const SensorSet::key_type& sensor,
+                        std::optional<Clock::duration> period)
+{
+    if (period)
+    {
+        auto& entry = _entries[sensor];
+        if (entry.next && entry.throttle != period)
+        {
+            // Apply the throttled period from the last read.
+            auto last = *entry.next - entry.throttle.value_or(entry.period);
+            entry.next = last + *period;
+        }
+        entry.throttle = period;
+        return;
+    }
+
+    auto it = _entries.find(sensor);
+    if (it == _entries.end() || !it->second.throttle)
+    {
+        return;
+    }
+
+    it->second.throttle.reset();
+    it->second.next.reset();
+    if (it->second.period.count() == 0)
+    {
+        _entries.erase(it);
+    }
+}
+
+bool Schedule::suspended(const SensorSet::key_type& sensor) const
+{
+    auto it = _entries.find(sensor);
+    return it != _entries.end() && it->second.throttle &&
+           it->second.throttle->count() == 0;
+}
+
+Schedule::Clock::duration
+    Schedule::period(const SensorSet::key_type& sensor) const
+{
+    auto it = _entries.find(sensor);
+    return it == _entries.end() ? Clock::duration{0} : it->second.period;
+}
+
+bool Schedule::due(const SensorSet::key_type& sensor, Clock::time_point now,
+                   Clock::duration slack) const
+{
+    auto it = _entries.find(sensor);
+    if (it == _entries.end())
+    {
+        return true;
+    }
+
+    const auto& entry = it->second;
+    if (entry.throttle && entry.throttle->count() == 0)
+    {
+        return false;
+    }
+
+    return !entry.next || now + slack >= *entry.next;
+}
+
+void Schedule::read(const SensorSet::key_type& sensor, Clock::time_point now)
+{
+    auto it = _entries.find(sensor);
+    if (it != _entries.end())
+    {
+        it->second.next = now +
+                          it->second.throttle.value_or(it->second.period);
+    }
+}
+
+} // namespace hwmon
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "sensorset.hpp"
+
+#include <chrono>
+#include <map>
+#include <optional>
+
+namespace hwmon
+{
+
+/** @class Schedule
+ *  @brief When each sensor is next due to be read.
+ *  @details By default every sensor is read every cycle.  A sensor given
+ *  a period is skipped by the cycles that start before the period since
+ *  its last read has expired.
+ */
+class Schedule
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Set how often a sensor is read.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *  @param[in] period - Time between reads, zero to read every cycle.
+     */
+    void period(const SensorSet::key_type& sensor, Clock::duration period);
+
+    /** @brief Get how often a sensor is read.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *
+     *  @return - Time between reads, zero if read every cycle.
+     */
+    Clock::duration period(const SensorSet::key_type& sensor) const;
+
+    /** @brief Throttle a sensor, overriding its period.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *  @param[in] period - Time between reads while throttled, zero to
+     *                      suspend its reads, std::nullopt to lift the
+     *                      throttle and read it again straight away.
+     */
+    void throttle(const SensorSet::key_type& sensor,
+                  std::optional<Clock::duration> period);
+
+    /** @brief Whether a sensor's reads are suspended.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     */
+    bool suspended(const SensorSet::key_type& sensor) const;
+
+    /** @brief Whether a sensor is due to be read.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *  @param[in] now - The current time.
+     *  @param[in] slack - How early a read may be, to absorb the jitter of
+     *                     the cycle timer.
+     *
+     *  @return - Whether the sensor should be read this cycle.
+     */
+    bool due(const SensorSet::key_type& sensor, Clock::time_point now,
+             Clock::duration slack) const;
+
+    /** @brief Record that a sensor was read.
+     *
+     *  @param[in] sensor - The sensor's identifiers.
+     *  @param[in] now - When it was read.
+     */
+    void read(const SensorSet::key_type& sensor, Clock::time_point now);
+
+  private:
+    struct Entry
+    {
+        /** @brief Time between reads. */
+        Clock::duration period{0};
+        /** @brief Time between reads while throttled, zero if suspended. */
+        std::optional<Clock::duration> throttle;
+        /** @brief When the sensor is next due. */
+        std::optional<Clock::time_point> next;
+    };
+
+    /** @brief Sensors not read every cycle. */
+    std::map<SensorSet::key_type, Entry> _entries;
+};
+
+} // namespace hwmon
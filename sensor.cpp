@@ -5,8 +5,11 @@
 #include "env.hpp"
 #include "gpio_handle.hpp"
 #include "hwmon.hpp"
+#include "iio.hpp"
+#include "rt.hpp"
 #include "sensorset.hpp"
 #include "sysfs.hpp"
+#include "util.hpp"
 
 #include <phosphor-logging/elog-errors.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
@@ -27,18 +30,48 @@ namespace sensor
 using namespace phosphor::logging;
 using namespace sdbusplus::xyz::openbmc_project::Common::Error;
 
+/**
+ * @brief Get the handle for a gpio, shared by all sensors it gates.
+ * @details A gpio line can only be requested once, so sensors gated by the
+ * same gpio share the handle rather than each requesting the line.
+ *
+ * @param[in] chip - gpiochip id
+ * @param[in] line - gpio line offset
+ *
+ * @return - The handle, nullptr on failure.
+ */
+static std::shared_ptr<gpioplus::HandleInterface> sharedGpioHandle(
+    const std::string& chip, const std::string& line)
+{
+    static std::map<std::pair<std::string, std::string>,
+                    std::weak_ptr<gpioplus::HandleInterface>>
+        handles;
+
+    auto& weak = handles[std::make_pair(chip, line)];
+    auto handle = weak.lock();
+    if (!handle)
+    {
+        handle = gpio::BuildGpioHandle(chip, line);
+        weak = handle;
+    }
+
+    return handle;
+}
+
 // todo: this can be simplified once we move to the double interface
 Sensor::Sensor(const SensorSet::key_type& sensor,
                const hwmonio::HwmonIOInterface* ioAccess,
                const std::string& devPath) :
     _sensor(sensor), _ioAccess(ioAccess), _devPath(devPath), _scale(0),
-    _hasFaultFile(false)
+    _hasFaultFile(false),
+    _useAverage(sensor.first == hwmon::type::power &&
+                phosphor::utility::isAverageEnvSet(sensor))
 {
     auto chip = env::getEnv("GPIOCHIP", sensor);
     auto access = env::getEnv("GPIO", sensor);
     if (!access.empty() && !chip.empty())
     {
-        _handle = gpio::BuildGpioHandle(chip, access);
+        _handle = sharedGpioHandle(chip, access);
 
         if (!_handle)
         {
@@ -61,6 +94,13 @@ Sensor::Sensor(const SensorSet::key_type& sensor,
     auto senRmRCs = env::getEnv("REMOVERCS", sensor);
     // Add sensor removal return codes defined per sensor
     addRemoveRCs(senRmRCs);
+
+    // Looked up once rather than on every read.
+    auto asyncReadTimeout = env::getEnv("ASYNC_READ_TIMEOUT", sensor);
+    if (!asyncReadTimeout.empty())
+    {
+        _asyncTimeout = std::chrono::milliseconds{std::stoi(asyncReadTimeout)};
+    }
 }
 
 void Sensor::addRemoveRCs(const std::string& rcList)
@@ -117,6 +157,22 @@ SensorValueType Sensor::adjustValue(SensorValueType value)
     return value;
 }
 
+std::optional<int64_t> Sensor::unadjustValue(SensorValueType value) const
+{
+    if (_sensorAdjusts.gain == 0.0)
+    {
+        return std::nullopt;
+    }
+
+    auto raw = static_cast<double>(value);
+    if constexpr (std::is_same<SensorValueType, double>::value)
+    {
+        raw /= std::pow(10, _scale);
+    }
+
+    return std::llround((raw - _sensorAdjusts.offset) / _sensorAdjusts.gain);
+}
+
 std::shared_ptr<ValueObject> Sensor::addValue(
     const RetryIO& retryIO, ObjectInfo& info, TimedoutMap& timedoutMap)
 {
@@ -145,12 +201,9 @@ std::shared_ptr<ValueObject> Sensor::addValue(
 
             // For sensors with attribute ASYNC_READ_TIMEOUT,
             // spawn a thread with timeout
-            auto asyncReadTimeout = env::getEnv("ASYNC_READ_TIMEOUT", _sensor);
-            if (!asyncReadTimeout.empty())
+            if (_asyncTimeout)
             {
-                std::chrono::milliseconds asyncTimeout{
-                    std::stoi(asyncReadTimeout)};
-                val = asyncRead(_sensor, _ioAccess, asyncTimeout, timedoutMap,
+                val = asyncRead(_sensor, _ioAccess, *_asyncTimeout, timedoutMap,
                                 _sensor.first, _sensor.second,
                                 hwmon::entry::cinput, std::get<size_t>(retryIO),
                                 std::get<std::chrono::milliseconds>(retryIO));
@@ -294,6 +347,45 @@ std::shared_ptr<PriorityObject> Sensor::addPriority(ObjectInfo& info,
     return iface;
 }
 
+void Sensor::openInput(void)
+{
+    // IIO channels have no hwmon attributes to keep open.
+    if (iio::isDevice(_ioAccess->path()))
+    {
+        return;
+    }
+
+    // The same attribute MainLoop::readSensor reads.
+    std::string entry = hwmon::entry::input;
+    if (_sensor.first == hwmon::type::pwm)
+    {
+        entry = "";
+    }
+    else if (_useAverage)
+    {
+        entry = hwmon::entry::average;
+    }
+    _input = rt::openAttribute(sysfs::make_sysfs_path(
+        _ioAccess->path(), _sensor.first, _sensor.second, entry));
+
+    auto fault = sysfs::make_sysfs_path(_ioAccess->path(), _sensor.first,
+                                        _sensor.second, hwmon::entry::fault);
+    _faultInput.reset();
+    if (std::filesystem::exists(fault))
+    {
+        _faultInput = rt::openAttribute(fault);
+    }
+}
+
+void Sensor::rebind(const hwmonio::HwmonIOInterface* ioAccess)
+{
+    _ioAccess = ioAccess;
+    if (_input || _faultInput)
+    {
+        openInput();
+    }
+}
+
 void gpioLock(const gpioplus::HandleInterface*&& handle)
 {
     handle->setValues({0});
@@ -307,8 +399,7 @@ std::optional<GpioLocker> gpioUnlock(const gpioplus::HandleInterface* handle)
     }
 
     handle->setValues({1});
-    // Default pause needed to guarantee sensors are ready
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    std::this_thread::sleep_for(gpioSettle);
     return GpioLocker(std::move(handle));
 }
 
@@ -318,17 +409,43 @@ SensorValueType asyncRead(
     std::chrono::milliseconds asyncTimeout, TimedoutMap& timedoutMap,
     const std::string& type, const std::string& id, const std::string& sensor,
     const size_t retries, const std::chrono::milliseconds delay)
+{
+    auto val = tryAsyncRead(sensorSetKey, ioAccess, asyncTimeout, timedoutMap,
+                            type, id, sensor, retries, delay);
+    if (!val)
+    {
+        if (val.error() == asyncReadTimedOut)
+        {
+            throw AsyncSensorReadTimeOut();
+        }
+#if NEGATIVE_ERRNO_ON_FAIL
+        if (val.error().category() == std::generic_category())
+        {
+            return -val.error().value();
+        }
+#endif
+        throw std::system_error(val.error());
+    }
+    return *val;
+}
+
+hwmonio::ReadResult tryAsyncRead(
+    const SensorSet::key_type& sensorSetKey,
+    const hwmonio::HwmonIOInterface* ioAccess,
+    std::chrono::milliseconds asyncTimeout, TimedoutMap& timedoutMap,
+    const std::string& type, const std::string& id, const std::string& sensor,
+    const size_t retries, const std::chrono::milliseconds delay)
 {
     // Default async read timeout
     bool valueIsValid = false;
-    std::future<int64_t> asyncThread;
+    std::future<hwmonio::ReadResult> asyncThread;
 
     auto asyncIter = timedoutMap.find(sensorSetKey);
     if (asyncIter == timedoutMap.end())
     {
         // If sensor not found in timedoutMap, spawn an async thread
         asyncThread =
-            std::async(std::launch::async, &hwmonio::HwmonIOInterface::read,
+            std::async(std::launch::async, &hwmonio::HwmonIOInterface::tryRead,
                        ioAccess, type, id, sensor, retries, delay);
         valueIsValid = true;
     }
@@ -357,11 +474,11 @@ SensorValueType asyncRead(
                 // Good sensor reads should skip the code below
             }
             // Async read thread has completed but had previously timed out (was
-            // found in the timedoutMap). Erase from timedoutMap and throw to
+            // found in the timedoutMap). Erase from timedoutMap and fail to
             // allow retry in the next read cycle. Not returning the read value
             // as the sensor reading may be bad / corrupted if it took so long.
             timedoutMap.erase(sensorSetKey);
-            throw AsyncSensorReadTimeOut();
+            return std::unexpected(asyncReadTimedOut);
         default:
             // Read timed out so add the thread to the timedoutMap (if the entry
             // already exists, operator[] updates it).
@@ -371,7 +488,7 @@ SensorValueType asyncRead(
             // stack. The destructor will otherwise block until the read
             // completes due to the limitation of std::async.
             timedoutMap[sensorSetKey] = std::move(asyncThread);
-            throw AsyncSensorReadTimeOut();
+            return std::unexpected(asyncReadTimedOut);
     }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "aux_cache.hpp"
 #include "hwmonio.hpp"
 #include "sensorset.hpp"
 #include "types.hpp"
@@ -8,6 +9,7 @@
 #include <stdplus/handle/managed.hpp>
 
 #include <cerrno>
+#include <chrono>
 #include <future>
 #include <map>
 #include <memory>
@@ -17,7 +19,12 @@
 namespace sensor
 {
 
-using TimedoutMap = std::map<SensorSet::key_type, std::future<int64_t>>;
+using TimedoutMap =
+    std::map<SensorSet::key_type, std::future<hwmonio::ReadResult>>;
+
+/** @brief The error of an async sensor read that timed out */
+inline const std::error_code asyncReadTimedOut{ETIMEDOUT,
+                                               std::system_category()};
 
 struct valueAdjust
 {
@@ -31,8 +38,7 @@ struct valueAdjust
 struct AsyncSensorReadTimeOut : public std::system_error
 {
     AsyncSensorReadTimeOut() :
-        system_error(std::error_code(ETIMEDOUT, std::system_category()),
-                     "Async sensor read timed out")
+        system_error(asyncReadTimedOut, "Async sensor read timed out")
     {}
 };
 
@@ -93,6 +99,17 @@ class Sensor
      */
     SensorValueType adjustValue(SensorValueType value);
 
+    /**
+     * @brief Reverses the adjustments made to a sensor value
+     * @details Converts a value in the units of the Value interface, such
+     * as a threshold, back to the raw value of the sysfs attributes.
+     *
+     * @param[in] value - Adjusted value
+     *
+     * @return - Raw sensor value, std::nullopt if it can't be recovered
+     */
+    std::optional<int64_t> unadjustValue(SensorValueType value) const;
+
     /**
      * @brief Add value interface and value property for sensor
      * @details When a sensor has an associated input file, the Sensor.Value
@@ -169,6 +186,18 @@ class Sensor
         return _handle.get();
     }
 
+    /**
+     * @brief Get the shared GPIO handle from the sensor.
+     * @details Sensors gated by the same GPIO share one handle.
+     *
+     * @return - The GPIO handle, can be empty.
+     */
+    inline const std::shared_ptr<gpioplus::HandleInterface>& getGpioHandle(
+        void) const
+    {
+        return _handle;
+    }
+
     /**
      * @brief Get whether the sensor has a fault file or not.
      *
@@ -179,6 +208,86 @@ class Sensor
         return _hasFaultFile;
     }
 
+    /**
+     * @brief Get the cached value of the fault attribute.
+     *
+     * @return - The fault cache
+     */
+    inline hwmon::AuxCache& getFaultCache(void)
+    {
+        return _fault;
+    }
+
+    /**
+     * @brief Get the cached value of the average_interval attribute.
+     *
+     * @return - The average_interval cache
+     */
+    inline hwmon::AuxCache& getAverageIntervalCache(void)
+    {
+        return _averageInterval;
+    }
+
+    /**
+     * @brief Get the ASYNC_READ_TIMEOUT of the sensor.
+     *
+     * @return - The timeout, nothing if the sensor isn't read async.
+     */
+    inline const std::optional<std::chrono::milliseconds>&
+        getAsyncTimeout(void) const
+    {
+        return _asyncTimeout;
+    }
+
+    /**
+     * @brief Get whether the average attribute is read instead of input.
+     * @details Set with AVERAGE_power<X>=true in the env.
+     *
+     * @return - true if the average attribute is read
+     */
+    inline bool useAverage(void) const
+    {
+        return _useAverage;
+    }
+
+    /**
+     * @brief Keep the attributes read every cycle open in real-time mode.
+     * @details The value attribute of the sensor, and its fault attribute
+     * if it has one, are opened.  Reads through the open attributes don't
+     * allocate.  Does nothing unless real-time mode is enabled, or for
+     * IIO devices, which have no such attributes.
+     */
+    void openInput(void);
+
+    /**
+     * @brief Get the value attribute kept open by openInput().
+     *
+     * @return - Pointer to the attribute, can be nullptr.
+     */
+    inline const hwmonio::Attribute* getInput(void) const
+    {
+        return _input ? &*_input : nullptr;
+    }
+
+    /**
+     * @brief Get the fault attribute kept open by openInput().
+     *
+     * @return - Pointer to the attribute, can be nullptr.
+     */
+    inline const hwmonio::Attribute* getFault(void) const
+    {
+        return _faultInput ? &*_faultInput : nullptr;
+    }
+
+    /**
+     * @brief Access the sensor through a new hwmon instance.
+     * @details For when the driver was bound to the device again.  The
+     * attributes kept open, if any, are opened again.
+     *
+     * @param[in] ioAccess - Hwmon sysfs access of the new instance.
+     */
+    void rebind(const hwmonio::HwmonIOInterface* ioAccess);
+
   private:
     /** @brief Sensor object's identifiers */
     SensorSet::key_type _sensor;
@@ -192,16 +301,38 @@ class Sensor
     /** @brief Structure for storing sensor adjustments */
     valueAdjust _sensorAdjusts;
 
-    /** @brief Optional pointer to GPIO handle. */
-    std::unique_ptr<gpioplus::HandleInterface> _handle;
+    /** @brief Optional pointer to GPIO handle, shared by sensors gated by
+     *         the same GPIO. */
+    std::shared_ptr<gpioplus::HandleInterface> _handle;
 
     /** @brief sensor scale from configuration. */
     int64_t _scale;
 
     /** @brief Tracks whether the sensor has a fault file or not. */
     bool _hasFaultFile;
+
+    /** @brief Last fault value read. */
+    hwmon::AuxCache _fault;
+
+    /** @brief Last average_interval value read. */
+    hwmon::AuxCache _averageInterval;
+
+    /** @brief ASYNC_READ_TIMEOUT from the env. */
+    std::optional<std::chrono::milliseconds> _asyncTimeout;
+
+    /** @brief Whether the average attribute is read instead of input. */
+    bool _useAverage;
+
+    /** @brief Value attribute kept open in real-time mode. */
+    std::optional<hwmonio::Attribute> _input;
+
+    /** @brief Fault attribute kept open in real-time mode. */
+    std::optional<hwmonio::Attribute> _faultInput;
 };
 
+/** @brief Default pause needed to guarantee gated sensors are ready. */
+static constexpr auto gpioSettle = std::chrono::milliseconds(500);
+
 /**
  * @brief Locks the gpio represented by the handle
  *
@@ -245,4 +376,19 @@ SensorValueType asyncRead(
     std::chrono::milliseconds asyncTimeout, TimedoutMap& timedoutMap,
     const std::string& type, const std::string& id, const std::string& sensor,
     const size_t retries, const std::chrono::milliseconds delay);
+
+/**
+ * @brief Asynchronously read a sensor with timeout, without throwing
+ *
+ * As asyncRead, but errors are returned rather than thrown, a timed out
+ * read returning asyncReadTimedOut.
+ *
+ * @return - The value read asynchronously, or the error
+ */
+hwmonio::ReadResult tryAsyncRead(
+    const SensorSet::key_type& sensorSetKey,
+    const hwmonio::HwmonIOInterface* ioAccess,
+    std::chrono::milliseconds asyncTimeout, TimedoutMap& timedoutMap,
+    const std::string& type, const std::string& id, const std::string& sensor,
+    const size_t retries, const std::chrono::milliseconds delay);
 } // namespace sensor
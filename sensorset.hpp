@@ -3,6 +3,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 
 /**
  * @class SensorSet
@@ -34,6 +35,18 @@ class SensorSet
      *
      */
     explicit SensorSet(const std::string& path);
+
+    /**
+     * @brief Constructor
+     * @details Holds sensors found by other means, such as the channels
+     *          of an IIO device.
+     *
+     * @param[in] container - the sensors
+     *
+     */
+    explicit SensorSet(container_t&& container) :
+        _container(std::move(container))
+    {}
     ~SensorSet() = default;
     SensorSet() = delete;
     SensorSet(const SensorSet&) = delete;
@@ -0,0 +1,128 @@
+#include "target_writer.hpp"
+
+#include "env.hpp"
+#include "hwmonio.hpp"
+#include "recovery.hpp"
+
+#include <phosphor-logging/elog-errors.hpp>
+#include <xyz/openbmc_project/Control/Device/error.hpp>
+
+#include <cstdlib>
+#include <format>
+#include <utility>
+
+using namespace phosphor::logging;
+
+namespace hwmon
+{
+
+TargetWriter::TargetWriter(const sdeventplus::Event& event,
+                           std::chrono::milliseconds window,
+                           std::chrono::milliseconds resync, Write&& write,
+                           Failure&& failure) :
+    _window(window), _resync(resync), _write(std::move(write)),
+    _failure(std::move(failure)), _timer(event, [this](auto&) { flush(); })
+{}
+
+std::unique_ptr<TargetWriter> TargetWriter::fromEnv(Write&& write,
+                                                    Failure&& failure)
+{
+    auto window = env::getEnv("TARGET_COALESCE");
+    if (window.empty())
+    {
+        return nullptr;
+    }
+
+    std::chrono::milliseconds resync{0};
+    auto resyncEnv = env::getEnv("TARGET_RESYNC");
+    if (!resyncEnv.empty())
+    {
+        resync = std::chrono::milliseconds{
+            std::strtoull(resyncEnv.c_str(), nullptr, 10)};
+    }
+
+    return std::make_unique<TargetWriter>(
+        sdeventplus::Event::get_default(),
+        std::chrono::milliseconds{std::strtoull(window.c_str(), nullptr, 10)},
+        resync, std::move(write), std::move(failure));
+}
+
+void TargetWriter::set(uint64_t value)
+{
+    // Last writer wins, the window is not extended by later values.
+    _pending = value;
+    if (!_timer.isEnabled())
+    {
+        _timer.restartOnce(_window);
+    }
+}
+
+bool TargetWriter::cancel()
+{
+    _timer.setEnabled(false);
+    return std::exchange(_pending, std::nullopt).has_value();
+}
+
+void TargetWriter::flush()
+{
+    if (!_pending)
+    {
+        return;
+    }
+
+    auto value = *_pending;
+    _pending.reset();
+
+    auto now = std::chrono::steady_clock::now();
+    if (_written == value &&
+        (_resync.count() == 0 || now - _writtenAt < _resync))
+    {
+        return;
+    }
+
+    try
+    {
+        _write(value);
+        _written = value;
+        _writtenAt = now;
+    }
+    catch (const std::system_error& e)
+    {
+        // The failure callback only returns while the device is recovered
+        // or rebound, which may lose the last value written.  Make sure
+        // the next value is written even if it is unchanged.
+        _written.reset();
+        _failure(e);
+    }
+}
+
+void targetWriteFailed(const std::system_error& e, const std::string& devPath,
+                       const std::string& file)
+{
+    if (!hwmonio::exitOnRemoval() &&
+        (e.code() == std::errc::no_such_file_or_directory ||
+         e.code() == std::errc::no_such_device))
+    {
+        // The driver was unbound, written again once it's bound again.
+        return;
+    }
+
+    using namespace sdbusplus::xyz::openbmc_project::Control::Device::Error;
+    report<WriteFailure>(
+        xyz::openbmc_project::Control::Device::WriteFailure::CALLOUT_ERRNO(
+            e.code().value()),
+        xyz::openbmc_project::Control::Device::WriteFailure::
+            CALLOUT_DEVICE_PATH(devPath.c_str()));
+
+    log<level::INFO>(std::format("Failing sysfs file: {} errno: {}", file,
+                                 e.code().value())
+                         .c_str());
+
+    if (!degrade(devPath))
+    {
+        exit(EXIT_FAILURE);
+    }
+    // Written again once the device has recovered.
+}
+
+} // namespace hwmon
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+
+namespace hwmon
+{
+
+/** @class TargetWriter
+ *  @brief Write-behind for fan target sysfs attributes.
+ *  @details Values set within the coalescing window replace one another and
+ *  only the last one is written once the window closes.  A value identical
+ *  to the last successful write is skipped, unless the resync interval has
+ *  expired since then.  Write failures are handed to the failure callback
+ *  from the event loop rather than to whoever set the value.  The callback
+ *  may exit, if it returns the next value is written even if unchanged.
+ */
+class TargetWriter
+{
+  public:
+    /** @brief Writes a value out, throws std::system_error on failure. */
+    using Write = std::function<void(uint64_t)>;
+    /** @brief Reports a failed write, may not return. */
+    using Failure = std::function<void(const std::system_error&)>;
+
+    TargetWriter() = delete;
+    TargetWriter(const TargetWriter&) = delete;
+    TargetWriter& operator=(const TargetWriter&) = delete;
+    TargetWriter(TargetWriter&&) = delete;
+    TargetWriter& operator=(TargetWriter&&) = delete;
+    ~TargetWriter() = default;
+
+    /** @brief Constructor
+     *
+     *  @param[in] event - The event loop to write from.
+     *  @param[in] window - How long to coalesce values for.
+     *  @param[in] resync - Interval after which an unchanged value is
+     *                      written again, zero to never rewrite it.
+     *  @param[in] write - Writes a value to sysfs.
+     *  @param[in] failure - Reports a failed write.
+     */
+    TargetWriter(const sdeventplus::Event& event,
+                 std::chrono::milliseconds window,
+                 std::chrono::milliseconds resync, Write&& write,
+                 Failure&& failure);
+
+    /** @brief Create a writer if TARGET_COALESCE is set in the env.
+     *
+     *  TARGET_COALESCE is the coalescing window and TARGET_RESYNC the
+     *  resync interval, both in milliseconds.
+     *
+     *  @param[in] write - Writes a value to sysfs.
+     *  @param[in] failure - Reports a failed write.
+     *
+     *  @return - The writer, nullptr if targets should be written
+     *            synchronously.
+     */
+    static std::unique_ptr<TargetWriter> fromEnv(Write&& write,
+                                                 Failure&& failure);
+
+    /** @brief Queue a value to be written.
+     *
+     *  @param[in] value - The target value.
+     */
+    void set(uint64_t value);
+
+    /** @brief Drop the value waiting to be written, if any.
+     *
+     *  @return - Whether a value was waiting.
+     */
+    bool cancel();
+
+  private:
+    /** @brief Write the pending value when the window closes. */
+    void flush();
+
+    /** @brief Coalescing window. */
+    std::chrono::milliseconds _window;
+    /** @brief Forced rewrite interval. */
+    std::chrono::milliseconds _resync;
+    /** @brief Writes a value to sysfs. */
+    Write _write;
+    /** @brief Reports a failed write. */
+    Failure _failure;
+    /** @brief Value waiting for the window to close. */
+    std::optional<uint64_t> _pending;
+    /** @brief Last value successfully written. */
+    std::optional<uint64_t> _written;
+    /** @brief When _written was written. */
+    std::chrono::steady_clock::time_point _writtenAt;
+    /** @brief Coalescing window timer. */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> _timer;
+};
+
+/** @brief Handle a failed write of a fan target.
+ *
+ *  A device that went away is waited for, otherwise the failure is
+ *  reported and the device degraded, see degrade().  Exits if the device
+ *  can't be recovered, so returns only if the target is to be written
+ *  again later.
+ *
+ *  @param[in] e - The failure.
+ *  @param[in] devPath - The /sys/devices sysfs path.
+ *  @param[in] file - The attribute written.
+ */
+void targetWriteFailed(const std::system_error& e, const std::string& devPath,
+                       const std::string& file);
+
+} // namespace hwmon
@@ -0,0 +1,72 @@
+#include "adaptive.hpp"
+
+#include <chrono>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+
+const SensorSet::key_type temp1 = std::make_pair("temp", "1");
+
+class AdaptiveTest : public ::testing::Test
+{
+  protected:
+    Adaptive adaptive{1s, 16s, 0.1};
+    Adaptive::Clock::time_point now;
+    Bounds bounds{{}, {90}};
+};
+
+TEST_F(AdaptiveTest, StableValueBacksOffToMax)
+{
+    EXPECT_EQ(1s, adaptive.update(temp1, 40, now, bounds));
+    EXPECT_EQ(2s, adaptive.update(temp1, 40, now + 1s, bounds));
+    EXPECT_EQ(4s, adaptive.update(temp1, 40, now + 3s, bounds));
+    EXPECT_EQ(8s, adaptive.update(temp1, 40, now + 7s, bounds));
+    EXPECT_EQ(16s, adaptive.update(temp1, 40, now + 15s, bounds));
+    EXPECT_EQ(16s, adaptive.update(temp1, 40, now + 31s, bounds));
+}
+
+TEST_F(AdaptiveTest, NearBoundPollsAtMin)
+{
+    adaptive.update(temp1, 40, now, bounds);
+    adaptive.update(temp1, 40, now + 1s, bounds);
+    EXPECT_EQ(1s, adaptive.update(temp1, 85, now + 3s, bounds));
+
+    // Past the bound too.
+    EXPECT_EQ(1s, adaptive.update(temp1, 95, now + 4s, bounds));
+}
+
+TEST_F(AdaptiveTest, FastRiseShrinksPeriod)
+{
+    for (auto i = 0; i < 5; ++i)
+    {
+        adaptive.update(temp1, 40, now + std::chrono::seconds(i), bounds);
+    }
+
+    // Rising 1 per second with 40 to go leaves 10s for 4 reads.
+    EXPECT_EQ(10s, adaptive.update(temp1, 50, now + 14s, bounds));
+
+    // Falling away from a high bound doesn't.
+    EXPECT_EQ(16s, adaptive.update(temp1, 40, now + 24s, bounds));
+}
+
+TEST_F(AdaptiveTest, LowBoundsAndUnsetBounds)
+{
+    Bounds low{{10, std::numeric_limits<double>::quiet_NaN()},
+               {std::numeric_limits<double>::quiet_NaN()}};
+
+    EXPECT_EQ(1s, adaptive.update(temp1, 50, now, low));
+    EXPECT_EQ(2s, adaptive.update(temp1, 50, now + 1s, low));
+
+    // Falling 4 per second with 20 to go leaves 5s for 4 reads.
+    EXPECT_EQ(1250ms, adaptive.update(temp1, 30, now + 6s, low));
+}
+
+} // namespace
+} // namespace hwmon
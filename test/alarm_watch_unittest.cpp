@@ -0,0 +1,65 @@
+#include "alarm_watch.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class AlarmAttributesTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/alarm_watch_unittest.XXXXXX";
+        dir = mkdtemp(tmpl);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    void touch(const std::string& name)
+    {
+        std::ofstream(dir / name) << "0\n";
+    }
+
+    std::filesystem::path dir;
+};
+
+TEST_F(AlarmAttributesTest, FindsMultiWordAlarms)
+{
+    // Listed in the SensorSet as crit, max and lcrit.
+    touch("temp1_crit_alarm");
+    touch("temp1_max_alarm");
+    touch("temp1_lcrit_alarm");
+    touch("temp1_alarm");
+
+    EXPECT_THAT(alarmAttributes(dir, {"temp", "1"}),
+                ElementsAre("alarm", "max_alarm", "lcrit_alarm", "crit_alarm"));
+}
+
+TEST_F(AlarmAttributesTest, LimitsAreNotAlarms)
+{
+    touch("temp1_crit");
+    touch("temp1_max");
+    touch("fan2_fault");
+
+    EXPECT_THAT(alarmAttributes(dir, {"temp", "1"}), IsEmpty());
+    EXPECT_THAT(alarmAttributes(dir, {"fan", "2"}), ElementsAre("fault"));
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,50 @@
+#include "aux_cache.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+
+TEST(AuxCacheTest, EmptyUntilSet)
+{
+    AuxCache cache;
+    EXPECT_FALSE(cache.get(AuxCache::Clock::now(), 1s));
+}
+
+TEST(AuxCacheTest, FreshUntilPeriodExpires)
+{
+    AuxCache cache;
+    auto now = AuxCache::Clock::now();
+
+    cache.set(5, now);
+    EXPECT_EQ(5, cache.get(now + 999ms, 1s));
+    EXPECT_FALSE(cache.get(now + 1s, 1s));
+}
+
+TEST(AuxCacheTest, ZeroPeriodAlwaysReads)
+{
+    AuxCache cache;
+    auto now = AuxCache::Clock::now();
+
+    cache.set(5, now);
+    EXPECT_FALSE(cache.get(now, 0s));
+}
+
+TEST(AuxCacheTest, InvalidateForcesRead)
+{
+    AuxCache cache;
+    auto now = AuxCache::Clock::now();
+
+    cache.set(5, now);
+    cache.invalidate();
+    EXPECT_FALSE(cache.get(now, 1s));
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,180 @@
+#include "bus_lock.hpp"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+
+TEST(I2cBusTest, FindsBus)
+{
+    EXPECT_EQ(3, i2cBus("/sys/devices/platform/ahb/ahb:apb/1e78a000.i2c/"
+                        "i2c-3/3-004c"));
+    EXPECT_EQ(3, i2cBus("/sys/devices/platform/ahb/i2c-3/3-004c/hwmon/hwmon2"));
+}
+
+TEST(I2cBusTest, MuxChannelIsInnermostBus)
+{
+    EXPECT_EQ(12, i2cBus("/sys/devices/platform/ahb/i2c-3/3-0070/i2c-12/"
+                         "12-0050"));
+}
+
+TEST(I2cBusTest, NotI2c)
+{
+    EXPECT_FALSE(i2cBus("/sys/devices/platform/pwm-tacho-controller@1e786000"));
+    EXPECT_FALSE(i2cBus("/sys/devices/platform/ahb/i2c-3"));
+}
+
+class BusLockTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char name[] = "/tmp/hwmon-bus-XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(name));
+        dir = name;
+        path = dir + "/i2c-1.lock";
+    }
+
+    void TearDown() override
+    {
+        unlink(path.c_str());
+        rmdir(dir.c_str());
+    }
+
+    std::string dir;
+    std::string path;
+};
+
+/** @brief Keep trying for the lock, as the event loop would. */
+BusLock::Attempt poll(BusLock& lock, BusLock::Clock::duration timeout)
+{
+    auto attempt = lock.lock(timeout);
+    while (attempt.state == BusLock::State::waiting)
+    {
+        std::this_thread::sleep_for(BusLock::retryInterval);
+        attempt = lock.lock(timeout);
+    }
+    return attempt;
+}
+
+TEST_F(BusLockTest, UncontendedLock)
+{
+    BusLock lock(path, 1s);
+    auto attempt = lock.lock(1s);
+    EXPECT_EQ(BusLock::State::held, attempt.state);
+    EXPECT_FALSE(attempt.waited);
+    EXPECT_TRUE(lock.held());
+
+    // Taking it again while held is a no-op.
+    attempt = lock.lock(1s);
+    EXPECT_EQ(BusLock::State::held, attempt.state);
+    EXPECT_FALSE(attempt.waited);
+
+    lock.unlock();
+    EXPECT_FALSE(lock.held());
+}
+
+TEST_F(BusLockTest, WaitsForOtherHolder)
+{
+    BusLock a(path, 1s);
+    BusLock b(path, 1s);
+    a.lock(1s);
+
+    // A contended lock doesn't block.
+    auto attempt = b.lock(1s);
+    EXPECT_EQ(BusLock::State::waiting, attempt.state);
+    EXPECT_FALSE(b.held());
+
+    std::this_thread::sleep_for(20ms);
+    a.unlock();
+
+    attempt = b.lock(1s);
+    EXPECT_EQ(BusLock::State::held, attempt.state);
+    ASSERT_TRUE(attempt.waited);
+    EXPECT_GE(*attempt.waited, 10ms);
+    EXPECT_TRUE(b.held());
+}
+
+TEST_F(BusLockTest, GivesUpAfterTimeout)
+{
+    BusLock a(path, 1s);
+    BusLock b(path, 1s);
+    a.lock(1s);
+
+    auto attempt = poll(b, 10ms);
+    EXPECT_EQ(BusLock::State::timedOut, attempt.state);
+    ASSERT_TRUE(attempt.waited);
+    EXPECT_GE(*attempt.waited, 10ms);
+    EXPECT_FALSE(b.held());
+
+    // Giving up doesn't keep a place in the queue.
+    a.unlock();
+    BusLock c(path, 1s);
+    EXPECT_EQ(BusLock::State::held, c.lock(1s).state);
+    EXPECT_TRUE(c.held());
+}
+
+TEST_F(BusLockTest, WaiterIsNotStarved)
+{
+    BusLock a(path, 5ms);
+    a.lock(1s);
+
+    int fds[2];
+    ASSERT_EQ(0, pipe2(fds, O_NONBLOCK));
+
+    auto pid = fork();
+    ASSERT_LE(0, pid);
+    if (pid == 0)
+    {
+        BusLock b(path, 1s);
+        poll(b, 1s);
+        char c = 'b';
+        (void)!write(fds[1], &c, 1);
+        b.unlock();
+        _exit(0);
+    }
+
+    // Stop the waiter, so it can't get in first by being quicker than a
+    // when the lock is released.
+    std::this_thread::sleep_for(20ms);
+    kill(pid, SIGSTOP);
+    auto resume = std::async(std::launch::async, [pid]() {
+        std::this_thread::sleep_for(20ms);
+        kill(pid, SIGCONT);
+    });
+
+    // Past its hold time, a hands the lock to the waiter and only takes it
+    // again once the waiter is done with it.
+    auto attempt = poll(a, 1s);
+    EXPECT_EQ(BusLock::State::held, attempt.state);
+    EXPECT_TRUE(a.held());
+    EXPECT_TRUE(attempt.waited);
+
+    char c = 0;
+    EXPECT_EQ(1, read(fds[0], &c, 1));
+    a.unlock();
+
+    resume.get();
+    int status = 0;
+    waitpid(pid, &status, 0);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,176 @@
+#include "control.hpp"
+#include "fan_pwm.hpp"
+#include "hwmonio_mock.hpp"
+#include "interface.hpp"
+#include "types.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::NiceMock;
+using ::testing::StrEq;
+using ::testing::StrictMock;
+
+class ControlTest : public ::testing::Test
+{
+  protected:
+    /** @brief Run the event loop long enough for the timeout to expire. */
+    void runFor(std::chrono::milliseconds duration)
+    {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end)
+        {
+            event.run(1ms);
+        }
+    }
+
+    std::unique_ptr<Control> makeControl()
+    {
+        return std::make_unique<Control>(
+            bus, "/xyz/openbmc_project/hwmon/1", event,
+            [this](bool quiesced) { changes.push_back(quiesced); });
+    }
+
+    /** @brief Expect the Quiesced property to change a number of times. */
+    void expectQuiescedChanges(int times)
+    {
+        EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                                   _, _, StrEq(Control::interface), _))
+            .Times(times)
+            .WillRepeatedly(
+                [](sd_bus*, const char*, const char*, const char** names) {
+                    EXPECT_STREQ("Quiesced", names[0]);
+                    return 0;
+                });
+    }
+
+    NiceMock<sdbusplus::SdBusMock> sdbusMock;
+    sdbusplus::bus_t bus = sdbusplus::get_mocked_new(&sdbusMock);
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    std::vector<bool> changes;
+};
+
+TEST_F(ControlTest, QuiesceTimesOut)
+{
+    auto control = makeControl();
+    control->quiesce(5ms);
+    EXPECT_TRUE(control->quiesced());
+    EXPECT_THAT(changes, ElementsAre(true));
+
+    // Quiescing again only restarts the timeout.
+    control->quiesce(5ms);
+    EXPECT_THAT(changes, ElementsAre(true));
+
+    runFor(20ms);
+    EXPECT_FALSE(control->quiesced());
+    EXPECT_THAT(changes, ElementsAre(true, false));
+}
+
+TEST_F(ControlTest, ResumeEndsPause)
+{
+    auto control = makeControl();
+    control->quiesce(1s);
+    control->resume();
+    EXPECT_FALSE(control->quiesced());
+    EXPECT_THAT(changes, ElementsAre(true, false));
+
+    // The timeout is cancelled, and resuming again does nothing.
+    control->resume();
+    runFor(10ms);
+    EXPECT_THAT(changes, ElementsAre(true, false));
+}
+
+TEST_F(ControlTest, QuiescedOnceDrained)
+{
+    auto control = makeControl();
+
+    // Reads may still be in flight.
+    expectQuiescedChanges(0);
+    control->quiesce(1s);
+    ::testing::Mock::VerifyAndClearExpectations(&sdbusMock);
+
+    expectQuiescedChanges(1);
+    control->drained();
+    control->drained();
+    ::testing::Mock::VerifyAndClearExpectations(&sdbusMock);
+
+    expectQuiescedChanges(1);
+    control->resume();
+    ::testing::Mock::VerifyAndClearExpectations(&sdbusMock);
+
+    // Draining after resuming is too late to matter.
+    expectQuiescedChanges(0);
+    control->drained();
+}
+
+TEST_F(ControlTest, FrequentStatisticsDoNotSignal)
+{
+    auto control = makeControl();
+
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               _, _, StrEq(Control::interface), _))
+        .WillOnce([](sd_bus*, const char*, const char*, const char** names) {
+            EXPECT_STREQ(Control::busLockWaits, names[0]);
+            return 0;
+        });
+    control->add(Control::busLockWaits);
+    control->add(Control::busLockWaitTime, 100);
+    control->add(Control::busLockWaitTime, 100);
+    EXPECT_EQ(200u, control->get(Control::busLockWaitTime));
+    control->set(Control::periodJitter, 10);
+    control->set(Control::periodJitter, 20);
+    EXPECT_EQ(20u, control->get(Control::periodJitter));
+}
+
+TEST_F(ControlTest, QuiesceObjectPublishesNaNAndHoldsTargets)
+{
+    auto io = std::make_unique<StrictMock<hwmonio::HwmonIOMock>>();
+    auto ioMock = io.get();
+
+    auto value = std::make_shared<ValueObject>(
+        bus, "/xyz/openbmc_project/sensors/fan_tach/fan0",
+        ValueObject::action::emit_no_signals);
+    value->value(42);
+    auto pwm = std::make_shared<FanPwm>(std::move(io), "devp", "1", bus,
+                                        "/xyz/openbmc_project/control/pwm1",
+                                        true, 0);
+
+    InterfaceMap obj;
+    obj[InterfaceType::VALUE] = value;
+    obj[InterfaceType::FAN_PWM] = pwm;
+
+    // Nothing is read while quiesced, so the value isn't published.
+    quiesceObject(obj, true);
+    EXPECT_TRUE(std::isnan(value->value()));
+
+    // The strict mock fails on any write while quiesced.
+    pwm->target(100);
+    ::testing::Mock::VerifyAndClearExpectations(ioMock);
+
+    EXPECT_CALL(*ioMock, write(100, StrEq("pwm"), StrEq("1"), _,
+                               hwmonio::retries, hwmonio::delay));
+    quiesceObject(obj, false);
+    EXPECT_EQ(100u, pwm->FanPwmObject::target());
+
+    // The value is left for the next read.
+    EXPECT_TRUE(std::isnan(value->value()));
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,79 @@
+#include "device_watch.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::string_literals;
+
+constexpr auto device = "/sys/devices/platform/ahb/i2c-3/3-004c";
+
+TEST(ParseUeventTest, Fields)
+{
+    auto msg = "remove@/devices/platform/ahb/i2c-3/3-004c/hwmon/hwmon2\0"
+               "ACTION=remove\0"
+               "DEVPATH=/devices/platform/ahb/i2c-3/3-004c/hwmon/hwmon2\0"
+               "SUBSYSTEM=hwmon\0"
+               "SEQNUM=1234\0"s;
+
+    auto uevent = parseUevent(msg);
+    ASSERT_TRUE(uevent);
+    EXPECT_EQ("remove", uevent->action);
+    EXPECT_EQ("/devices/platform/ahb/i2c-3/3-004c/hwmon/hwmon2",
+              uevent->devpath);
+    EXPECT_EQ("hwmon", uevent->subsystem);
+}
+
+TEST(ParseUeventTest, Incomplete)
+{
+    EXPECT_FALSE(parseUevent("add@/devices/foo"));
+    EXPECT_FALSE(parseUevent("add@/devices/foo\0SUBSYSTEM=hwmon\0"s));
+    EXPECT_FALSE(parseUevent("libudev\0ACTION=add\0"s));
+}
+
+TEST(InstanceOfTest, HwmonOfDevice)
+{
+    EXPECT_EQ("hwmon5",
+              instanceOf("/devices/platform/ahb/i2c-3/3-004c/hwmon/hwmon5",
+                         device));
+}
+
+TEST(InstanceOfTest, NotHwmonOfDevice)
+{
+    // Another device on the bus.
+    EXPECT_EQ("", instanceOf("/devices/platform/ahb/i2c-3/3-004d/hwmon/hwmon5",
+                             device));
+    // The device itself.
+    EXPECT_EQ("", instanceOf("/devices/platform/ahb/i2c-3/3-004c", device));
+    // A child of the device.
+    EXPECT_EQ("", instanceOf("/devices/platform/ahb/i2c-3/3-004c/hwmon/"
+                             "hwmon5/power",
+                             device));
+    // A device whose name starts the same.
+    EXPECT_EQ("", instanceOf("/devices/platform/ahb/i2c-3/3-004c0/hwmon/"
+                             "hwmon5",
+                             device));
+}
+
+TEST(FindInstanceTest, FindsInstance)
+{
+    char tmpl[] = "/tmp/device_watch_unittest.XXXXXX";
+    std::filesystem::path dir = mkdtemp(tmpl);
+
+    EXPECT_EQ("", findInstance(dir));
+
+    std::filesystem::create_directories(dir / "hwmon" / "hwmon7");
+    EXPECT_EQ("hwmon7", findInstance(dir));
+
+    std::filesystem::remove_all(dir);
+}
+
+} // namespace
+} // namespace hwmon
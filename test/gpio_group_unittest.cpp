@@ -0,0 +1,103 @@
+#include "gpio_group.hpp"
+
+#include <gpioplus/test/handle.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace sensor
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+using ::testing::ElementsAre;
+using ::testing::InSequence;
+using ::testing::StrictMock;
+
+class GpioGroupTest : public ::testing::Test
+{
+  protected:
+    /** @brief Run the event loop long enough for the timers to fire. */
+    void runFor(std::chrono::milliseconds duration)
+    {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end)
+        {
+            event.run(1ms);
+        }
+    }
+
+    std::unique_ptr<GpioGroup> makeGroup(std::chrono::milliseconds hold)
+    {
+        auto group = std::make_unique<GpioGroup>(
+            event, handle, 2ms, hold,
+            [this](const std::vector<SensorSet::key_type>& sensors) {
+                reads.push_back(sensors.size());
+            });
+        group->add(std::make_pair(std::string("temp"), std::string("1")));
+        group->add(std::make_pair(std::string("temp"), std::string("2")));
+        return group;
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    std::shared_ptr<StrictMock<gpioplus::test::HandleMock>> handle =
+        std::make_shared<StrictMock<gpioplus::test::HandleMock>>();
+    std::vector<size_t> reads;
+};
+
+TEST_F(GpioGroupTest, ReadsAllSensorsOnceSettled)
+{
+    InSequence seq;
+    EXPECT_CALL(*handle, setValues(ElementsAre(1)));
+    EXPECT_CALL(*handle, setValues(ElementsAre(0)));
+
+    auto group = makeGroup(0ms);
+    group->start();
+
+    // Unlocking doesn't block, the reads happen once settled.
+    EXPECT_TRUE(reads.empty());
+    runFor(10ms);
+    EXPECT_THAT(reads, ElementsAre(2));
+}
+
+TEST_F(GpioGroupTest, StartWhileSettlingIsIgnored)
+{
+    InSequence seq;
+    EXPECT_CALL(*handle, setValues(ElementsAre(1)));
+    EXPECT_CALL(*handle, setValues(ElementsAre(0)));
+
+    auto group = makeGroup(0ms);
+    group->start();
+    group->start();
+    runFor(10ms);
+    EXPECT_THAT(reads, ElementsAre(2));
+}
+
+TEST_F(GpioGroupTest, HoldSkipsSettling)
+{
+    InSequence seq;
+    EXPECT_CALL(*handle, setValues(ElementsAre(1)));
+    EXPECT_CALL(*handle, setValues(ElementsAre(0)));
+
+    auto group = makeGroup(1s);
+    group->start();
+    runFor(10ms);
+    EXPECT_THAT(reads, ElementsAre(2));
+
+    // Still held unlocked, so the sensors are read straight away.
+    group->start();
+    EXPECT_THAT(reads, ElementsAre(2, 2));
+
+    // Locked on destruction.
+    group.reset();
+}
+
+} // namespace
+} // namespace sensor
@@ -2,7 +2,11 @@
 #include "hwmonio.hpp"
 
 #include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <string>
+#include <system_error>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -52,5 +56,72 @@ TEST_F(HwmonIOTest, ReadExceptsRetryable)
     EXPECT_THAT(_hwmonio.read(_type, _id, _sensor, _retries, _delay), _value);
 }
 
+TEST_F(HwmonIOTest, RetriesAreCounted)
+{
+    auto before = retryCount();
+    EXPECT_CALL(_mock, read(_))
+        .WillOnce(&SetErrnoExcept)
+        .WillOnce(Return(_value));
+    _hwmonio.read(_type, _id, _sensor, _retries, _delay);
+    EXPECT_EQ(before + 1, retryCount());
+}
+
+int64_t SetErrnoPerm(const std::string&)
+{
+    errno = EPERM;
+    throw std::runtime_error("not allowed");
+}
+
+TEST_F(HwmonIOTest, TryReadReturnsError)
+{
+    EXPECT_CALL(_mock, read(_)).WillOnce(&SetErrnoPerm);
+    auto val = _hwmonio.tryRead(_type, _id, _sensor, _retries, _delay);
+    ASSERT_FALSE(val);
+    EXPECT_EQ(std::errc::operation_not_permitted, val.error());
+}
+
+TEST(FileSystemTest, TryReadAndWrite)
+{
+    char dir[] = "/tmp/hwmoniotestXXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+    auto path = std::string(dir) + "/temp1_input";
+
+    std::ofstream(path) << " 1234\n";
+    EXPECT_EQ(1234, fileSystemImpl.tryRead(path));
+
+    EXPECT_TRUE(fileSystemImpl.tryWrite(path, 56));
+    EXPECT_EQ(56, fileSystemImpl.tryRead(path));
+
+    std::ofstream(path) << "abc\n";
+    EXPECT_EQ(std::io_errc::stream, fileSystemImpl.tryRead(path).error());
+
+    std::filesystem::remove_all(dir);
+    EXPECT_EQ(std::errc::no_such_file_or_directory,
+              fileSystemImpl.tryRead(path).error());
+}
+
+TEST(UpdateIntervalTest, ReadsInterval)
+{
+    FileSystemMock mock;
+    EXPECT_CALL(mock, read("abcd/update_interval")).WillOnce(Return(2000));
+    EXPECT_EQ(std::chrono::milliseconds{2000},
+              readUpdateInterval("abcd", &mock));
+}
+
+TEST(UpdateIntervalTest, MissingIntervalIsEmpty)
+{
+    FileSystemMock mock;
+    EXPECT_CALL(mock, read(_)).WillOnce(&SetErrnoExcept);
+    EXPECT_FALSE(readUpdateInterval("abcd", &mock));
+}
+
+TEST(UpdateIntervalTest, WritesInterval)
+{
+    FileSystemMock mock;
+    EXPECT_CALL(mock, write("abcd/update_interval", 500));
+    EXPECT_TRUE(
+        writeUpdateInterval("abcd", std::chrono::milliseconds{500}, &mock));
+}
+
 } // namespace
 } // namespace hwmonio
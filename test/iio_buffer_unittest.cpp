@@ -0,0 +1,270 @@
+#include "iio_buffer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace iio
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+
+TEST(ScanTypeTest, Parses)
+{
+    auto type = ScanType::parse("be:s12/16>>4");
+    ASSERT_TRUE(type);
+    EXPECT_TRUE(type->bigEndian);
+    EXPECT_TRUE(type->isSigned);
+    EXPECT_EQ(12u, type->realBits);
+    EXPECT_EQ(16u, type->storageBits);
+    EXPECT_EQ(4u, type->shift);
+    EXPECT_EQ(2u, type->bytes());
+    EXPECT_EQ(1u, type->repeat);
+    EXPECT_EQ(2u, type->size());
+}
+
+TEST(ScanTypeTest, ParsesRepeat)
+{
+    auto type = ScanType::parse("le:u24/32X2>>0");
+    ASSERT_TRUE(type);
+    EXPECT_EQ(2u, type->repeat);
+    EXPECT_EQ(4u, type->bytes());
+    EXPECT_EQ(8u, type->size());
+
+    EXPECT_FALSE(ScanType::parse("le:u24/32X0>>0"));
+}
+
+TEST(ScanTypeTest, RejectsInvalid)
+{
+    EXPECT_FALSE(ScanType::parse("le:s12/12>>4"));
+    EXPECT_FALSE(ScanType::parse("le:s12/10>>0"));
+    EXPECT_FALSE(ScanType::parse("me:s12/16>>0"));
+    EXPECT_FALSE(ScanType::parse("le:s12/16"));
+}
+
+TEST(ScanTypeTest, DecodesLittleEndianUnsigned)
+{
+    auto type = ScanType::parse("le:u12/16>>0");
+    const uint8_t data[] = {0x34, 0x12};
+    // Bits above the 12 real ones are dropped.
+    EXPECT_EQ(0x234, type->decode(data));
+}
+
+TEST(ScanTypeTest, DecodesBigEndianSignedShifted)
+{
+    auto type = ScanType::parse("be:s12/16>>4");
+    // -2 in 12 bits, shifted up by 4.
+    const uint8_t data[] = {0xff, 0xe0};
+    EXPECT_EQ(-2, type->decode(data));
+}
+
+TEST(ScanLayoutTest, AlignsAndPads)
+{
+    auto u16 = *ScanType::parse("le:u16/16>>0");
+    auto u32 = *ScanType::parse("le:u32/32>>0");
+
+    // u16 at 0, u32 aligned to 4, u16 at 8, padded to 12.
+    ScanLayout layout({u16, u32, u16});
+    EXPECT_EQ(12u, layout.size());
+
+    const uint8_t scan[] = {1, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0};
+    EXPECT_EQ(1, layout.decode(scan, 0));
+    EXPECT_EQ(2, layout.decode(scan, 1));
+    EXPECT_EQ(3, layout.decode(scan, 2));
+}
+
+TEST(ScanLayoutTest, CountsRepeats)
+{
+    auto u16 = *ScanType::parse("le:u16/16>>0");
+    auto u16x3 = *ScanType::parse("le:u16/16X3>>0");
+    auto u8 = *ScanType::parse("le:u8/8>>0");
+
+    // u16 at 0, 3 x u16 aligned to 6, u8 at 12, padded to 18.
+    ScanLayout layout({u16, u16x3, u8});
+    EXPECT_EQ(18u, layout.size());
+
+    const uint8_t scan[] = {1, 0, 0, 0, 0, 0, 2, 0, 7, 0,
+                            8, 0, 3, 0, 0, 0, 0, 0};
+    EXPECT_EQ(1, layout.decode(scan, 0));
+    EXPECT_EQ(2, layout.decode(scan, 1));
+    EXPECT_EQ(3, layout.decode(scan, 2));
+}
+
+TEST(SummaryTest, MinMaxMean)
+{
+    Summary summary;
+    EXPECT_EQ(0, summary.mean());
+
+    for (auto value : {3.0, 1.0, 2.0})
+    {
+        summary.add(value);
+    }
+    EXPECT_EQ(1.0, summary.min);
+    EXPECT_EQ(3.0, summary.max);
+    EXPECT_EQ(2.0, summary.mean());
+    EXPECT_EQ(3u, summary.count);
+}
+
+TEST(RawRingTest, WrapsAndKeepsNewest)
+{
+    static constexpr auto name = "/hwmon-iio-buffer-test";
+    RawRing ring(name, 8, 2);
+
+    auto fd = shm_open(name, O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    auto length = sizeof(RawRing::Header) + 8;
+    auto addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(MAP_FAILED, addr);
+    auto header = static_cast<const RawRing::Header*>(addr);
+    auto data = static_cast<const uint8_t*>(addr) + sizeof(RawRing::Header);
+
+    const uint8_t first[] = {1, 2, 3, 4, 5, 6};
+    ring.write(first, sizeof(first));
+    const uint8_t second[] = {7, 8, 9, 10};
+    ring.write(second, sizeof(second));
+
+    EXPECT_EQ(8u, header->capacity);
+    EXPECT_EQ(2u, header->scanSize);
+    EXPECT_EQ(10u, header->head);
+    EXPECT_EQ(std::vector<uint8_t>({9, 10, 3, 4, 5, 6, 7, 8}),
+              std::vector<uint8_t>(data, data + 8));
+
+    munmap(addr, length);
+}
+
+class BufferStreamTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/iio_buffer_unittest.XXXXXX";
+        dir = mkdtemp(tmpl);
+        std::filesystem::create_directories(dir / "scan_elements");
+        std::filesystem::create_directories(dir / "buffer");
+        write("scan_elements/in_voltage0_en", "0");
+        write("scan_elements/in_voltage0_index", "0");
+        write("scan_elements/in_voltage0_type", "le:u16/16>>0");
+        write("in_voltage0_scale", "2");
+        write("buffer/enable", "0");
+        write("buffer/length", "0");
+
+        // A FIFO stands in for the device node.
+        node = dir / "node";
+        ASSERT_EQ(0, mkfifo(node.c_str(), 0600));
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    void write(const std::string& attr, const std::string& value)
+    {
+        std::ofstream(dir / attr) << value;
+    }
+
+    std::string read(const std::string& attr)
+    {
+        std::string value;
+        std::ifstream(dir / attr) >> value;
+        return value;
+    }
+
+    std::unique_ptr<BufferStream> makeStream(size_t length)
+    {
+        return std::make_unique<BufferStream>(event, dir, node,
+                                              std::vector{sensor}, length,
+                                              "", "");
+    }
+
+    /** @brief Run the event loop long enough for the buffer to be read. */
+    void runFor(std::chrono::milliseconds duration)
+    {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end)
+        {
+            event.run(1ms);
+        }
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    std::filesystem::path dir;
+    std::string node;
+    SensorSet::key_type sensor{"in", "0"};
+};
+
+TEST_F(BufferStreamTest, EnablesBuffer)
+{
+    auto stream = makeStream(4);
+    EXPECT_TRUE(stream->streams(sensor));
+    EXPECT_FALSE(stream->streams({"in", "1"}));
+    EXPECT_EQ("1", read("scan_elements/in_voltage0_en"));
+    EXPECT_EQ("4", read("buffer/length"));
+    EXPECT_EQ("1", read("buffer/enable"));
+
+    stream.reset();
+    EXPECT_EQ("0", read("buffer/enable"));
+}
+
+TEST_F(BufferStreamTest, RejectsZeroLength)
+{
+    EXPECT_THROW(makeStream(0), std::system_error);
+    EXPECT_EQ("0", read("buffer/enable"));
+}
+
+TEST_F(BufferStreamTest, ReadsScans)
+{
+    auto stream = makeStream(4);
+    auto fd = open(node.c_str(), O_WRONLY | O_NONBLOCK);
+    ASSERT_GE(fd, 0);
+
+    // Two scans and half of one, only whole scans are summarised.
+    const uint8_t scans[] = {5, 0, 7, 0, 9};
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(scans)),
+              ::write(fd, scans, sizeof(scans)));
+    runFor(10ms);
+
+    auto summary = stream->take(sensor);
+    ASSERT_TRUE(summary);
+    EXPECT_EQ(2u, summary->count);
+    EXPECT_EQ(10.0, summary->min);
+    EXPECT_EQ(14.0, summary->max);
+    EXPECT_FALSE(stream->take(sensor));
+    EXPECT_TRUE(stream->streams(sensor));
+
+    close(fd);
+}
+
+TEST_F(BufferStreamTest, FallsBackToPollingWhenClosed)
+{
+    auto stream = makeStream(4);
+    auto fd = open(node.c_str(), O_WRONLY | O_NONBLOCK);
+    ASSERT_GE(fd, 0);
+    runFor(5ms);
+    EXPECT_TRUE(stream->streams(sensor));
+
+    close(fd);
+    runFor(10ms);
+    EXPECT_FALSE(stream->streams(sensor));
+    EXPECT_EQ("0", read("buffer/enable"));
+}
+
+} // namespace
+} // namespace iio
@@ -0,0 +1,107 @@
+#include "iio.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace iio
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+
+class IioTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char name[] = "/tmp/hwmon-iio-XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(name));
+        root = name;
+        path = root / "iio:device0";
+        fs::create_directory(path);
+
+        attr("in_voltage0_raw", "1000");
+        attr("in_voltage1_raw", "5");
+        attr("in_voltage_scale", "0.5");
+        attr("in_voltage1_scale", "2");
+        attr("in_voltage1_offset", "10");
+        attr("in_temp0_raw", "40");
+        attr("in_voltage0-voltage1_raw", "7");
+        attr("name", "adc");
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(root);
+    }
+
+    void attr(const std::string& name, const std::string& value)
+    {
+        std::ofstream(path / name) << value << "\n";
+    }
+
+    fs::path root;
+    fs::path path;
+};
+
+TEST_F(IioTest, IsDevice)
+{
+    EXPECT_TRUE(isDevice(path));
+    EXPECT_TRUE(isDevice(path.string() + "/"));
+    EXPECT_FALSE(isDevice("/sys/class/hwmon/hwmon0"));
+}
+
+TEST_F(IioTest, FindsChannelsAsSensors)
+{
+    auto sensors = findSensors(path);
+
+    EXPECT_EQ(3u, sensors.size());
+    EXPECT_THAT(sensors[std::make_pair("in", "0")],
+                ::testing::ElementsAre("input"));
+    EXPECT_EQ(1u, sensors.count(std::make_pair("in", "1")));
+    EXPECT_EQ(1u, sensors.count(std::make_pair("temp", "0")));
+}
+
+TEST_F(IioTest, ReadAppliesScaleAndOffset)
+{
+    IioIO io(path);
+
+    // Shared scale.
+    EXPECT_EQ(500, io.read("in", "0", "input", hwmonio::retries,
+                           hwmonio::delay));
+    // Channel scale and offset.
+    EXPECT_EQ(30, io.read("in", "1", "input", hwmonio::retries,
+                          hwmonio::delay));
+    // No scale.
+    EXPECT_EQ(40, io.read("temp", "0", "input", hwmonio::retries,
+                          hwmonio::delay));
+}
+
+TEST_F(IioTest, CalibrationIsCached)
+{
+    IioIO io(path);
+    EXPECT_EQ(500, io.read("in", "0", "input", hwmonio::retries,
+                           hwmonio::delay));
+
+    attr("in_voltage_scale", "1");
+    attr("in_voltage0_raw", "1002");
+    EXPECT_EQ(501, io.read("in", "0", "input", hwmonio::retries,
+                           hwmonio::delay));
+}
+
+TEST_F(IioTest, UnsupportedAccessThrows)
+{
+    IioIO io(path);
+    EXPECT_THROW(io.read("in", "0", "fault", 0, hwmonio::delay),
+                 std::system_error);
+    EXPECT_THROW(io.write(1, "in", "0", "input", 0, hwmonio::delay),
+                 std::system_error);
+}
+
+} // namespace
+} // namespace iio
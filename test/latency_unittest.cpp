@@ -0,0 +1,70 @@
+#include "latency.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+using Move = LatencyTracker::Move;
+
+const SensorSet::key_type sensor{"temp", "1"};
+
+TEST(LatencyTrackerTest, IsolatesAfterReadsOverBudget)
+{
+    LatencyTracker latency(100ms);
+
+    EXPECT_EQ(Move::none, latency.record(sensor, 150ms));
+    EXPECT_EQ(Move::none, latency.record(sensor, 150ms));
+    EXPECT_FALSE(latency.timeout(sensor));
+    EXPECT_EQ(Move::toAsync, latency.record(sensor, 150ms));
+
+    // Twice the p99.
+    EXPECT_EQ(300ms, latency.timeout(sensor));
+    EXPECT_EQ(150ms, latency.ewma(sensor));
+    EXPECT_EQ(150ms, latency.p99(sensor));
+}
+
+TEST(LatencyTrackerTest, OccasionalSlowReadsAreTolerated)
+{
+    LatencyTracker latency(100ms);
+
+    for (auto i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(Move::none, latency.record(sensor, 150ms));
+        EXPECT_EQ(Move::none, latency.record(sensor, 150ms));
+        EXPECT_EQ(Move::none, latency.record(sensor, 10ms));
+    }
+    EXPECT_FALSE(latency.timeout(sensor));
+}
+
+TEST(LatencyTrackerTest, MovesBackOnceRecovered)
+{
+    LatencyTracker latency(100ms);
+
+    for (auto i = 0; i < 3; ++i)
+    {
+        latency.record(sensor, 150ms);
+    }
+    ASSERT_TRUE(latency.timeout(sensor));
+
+    // Under budget but not by enough doesn't count.
+    for (auto i = 0; i < 20; ++i)
+    {
+        EXPECT_EQ(Move::none, latency.record(sensor, 60ms));
+    }
+
+    for (auto i = 0; i < 9; ++i)
+    {
+        EXPECT_EQ(Move::none, latency.record(sensor, 10ms));
+    }
+    EXPECT_EQ(Move::toSync, latency.record(sensor, 10ms));
+    EXPECT_FALSE(latency.timeout(sensor));
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,161 @@
+#include "load_shed.hpp"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using ::testing::ElementsAre;
+
+SensorSet::key_type key(const std::string& type, const std::string& id)
+{
+    return std::make_pair(type, id);
+}
+
+TEST(LoadShedTest, HighestPriorityFirstThenUnprioritized)
+{
+    LoadShed shed;
+    shed.priority(key("temp", "2"), 1);
+    shed.priority(key("temp", "3"), 0);
+    shed.priority(key("in", "1"), 1);
+
+    std::vector<SensorSet::key_type> sensors = {
+        key("fan", "1"), key("in", "1"), key("temp", "1"), key("temp", "2"),
+        key("temp", "3")};
+    shed.sort(sensors);
+
+    EXPECT_THAT(sensors, ElementsAre(key("temp", "3"), key("in", "1"),
+                                     key("temp", "2"), key("fan", "1"),
+                                     key("temp", "1")));
+}
+
+TEST(LoadShedTest, DeferredFirstWithinPriority)
+{
+    LoadShed shed;
+    shed.priority(key("temp", "1"), 0);
+    shed.defer(key("temp", "3"));
+    shed.defer(key("in", "1"));
+
+    std::vector<SensorSet::key_type> sensors = {
+        key("in", "1"), key("temp", "1"), key("temp", "2"), key("temp", "3")};
+    shed.sort(sensors);
+
+    // A deferred sensor doesn't overtake a higher priority one.
+    EXPECT_THAT(sensors, ElementsAre(key("temp", "1"), key("in", "1"),
+                                     key("temp", "3"), key("temp", "2")));
+}
+
+TEST(LoadShedTest, ReadClearsDeferral)
+{
+    LoadShed shed;
+    shed.defer(key("temp", "1"));
+    EXPECT_TRUE(shed.deferred(key("temp", "1")));
+
+    shed.read(key("temp", "1"));
+    EXPECT_FALSE(shed.deferred(key("temp", "1")));
+}
+
+TEST(LoadShedTest, CarryOverReadsEverySensor)
+{
+    LoadShed shed;
+    std::vector<SensorSet::key_type> all;
+    for (auto i = 0; i < 10; ++i)
+    {
+        all.push_back(key("temp", std::to_string(i)));
+    }
+
+    // Cycles with only the time to read 4 of the 10 sensors.
+    std::set<SensorSet::key_type> read;
+    for (auto cycle = 0; cycle < 3; ++cycle)
+    {
+        auto sensors = all;
+        shed.sort(sensors);
+        for (size_t i = 0; i < sensors.size(); ++i)
+        {
+            if (i < 4)
+            {
+                shed.read(sensors[i]);
+                read.insert(sensors[i]);
+            }
+            else
+            {
+                shed.defer(sensors[i]);
+            }
+        }
+    }
+
+    EXPECT_EQ(all.size(), read.size());
+}
+
+TEST(LoadShedTest, LongDeferredOvertakesPriority)
+{
+    LoadShed shed;
+    shed.priority(key("temp", "1"), 0);
+    shed.priority(key("temp", "2"), 1);
+    shed.priority(key("fan", "1"), 5);
+    shed.priority(key("fan", "2"), 5);
+
+    std::vector<SensorSet::key_type> all = {key("fan", "1"), key("fan", "2"),
+                                            key("temp", "1"),
+                                            key("temp", "2")};
+
+    // Cycles with only the time to read 2 of the 4 sensors, so with
+    // priority alone the fans would never be read.
+    std::vector<std::vector<SensorSet::key_type>> reads;
+    for (uint64_t cycle = 0; cycle < LoadShed::defaultMaxDeferrals + 2;
+         ++cycle)
+    {
+        auto sensors = all;
+        shed.sort(sensors);
+        reads.emplace_back(sensors.begin(), sensors.begin() + 2);
+        for (size_t i = 0; i < sensors.size(); ++i)
+        {
+            if (i < 2)
+            {
+                shed.read(sensors[i]);
+            }
+            else
+            {
+                shed.defer(sensors[i]);
+            }
+        }
+    }
+
+    for (uint64_t cycle = 0; cycle < LoadShed::defaultMaxDeferrals; ++cycle)
+    {
+        EXPECT_THAT(reads[cycle], ElementsAre(key("temp", "1"),
+                                              key("temp", "2")));
+    }
+    EXPECT_THAT(reads[LoadShed::defaultMaxDeferrals],
+                ElementsAre(key("fan", "1"), key("fan", "2")));
+    EXPECT_THAT(reads[LoadShed::defaultMaxDeferrals + 1],
+                ElementsAre(key("temp", "1"), key("temp", "2")));
+}
+
+TEST(LoadShedTest, NoMaxDeferralsKeepsPriority)
+{
+    LoadShed shed;
+    shed.maxDeferrals(0);
+    shed.priority(key("temp", "1"), 0);
+    shed.priority(key("fan", "1"), 5);
+
+    for (auto cycle = 0; cycle < 10; ++cycle)
+    {
+        std::vector<SensorSet::key_type> sensors = {key("fan", "1"),
+                                                    key("temp", "1")};
+        shed.sort(sensors);
+        EXPECT_EQ(key("temp", "1"), sensors.front());
+        shed.read(sensors[0]);
+        shed.defer(sensors[1]);
+    }
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,100 @@
+#include "page_order.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using ::testing::ElementsAre;
+
+SensorSet::key_type key(const std::string& type, const std::string& id)
+{
+    return std::make_pair(type, id);
+}
+
+TEST(PageFromLabelTest, TrailingNumberIsPagePlusOne)
+{
+    EXPECT_EQ(0, pageFromLabel("vout1"));
+    EXPECT_EQ(2, pageFromLabel("iout3"));
+    EXPECT_EQ(11, pageFromLabel("pout12"));
+}
+
+TEST(PageFromLabelTest, UnpagedLabels)
+{
+    EXPECT_FALSE(pageFromLabel("vin"));
+    EXPECT_FALSE(pageFromLabel("12"));
+    EXPECT_FALSE(pageFromLabel("vout0"));
+    EXPECT_FALSE(pageFromLabel(""));
+}
+
+TEST(PageOrderTest, UnknownPagesFirstThenByPage)
+{
+    PageOrder order;
+    order.set(key("curr", "2"), 1);
+    order.set(key("curr", "3"), 0);
+    order.set(key("in", "2"), 1);
+
+    std::vector<SensorSet::key_type> sensors = {
+        key("curr", "1"), key("curr", "2"), key("curr", "3"), key("in", "1"),
+        key("in", "2")};
+    order.sort(sensors);
+
+    EXPECT_THAT(sensors, ElementsAre(key("curr", "1"), key("in", "1"),
+                                     key("curr", "3"), key("curr", "2"),
+                                     key("in", "2")));
+}
+
+TEST(PageOrderTest, NoPagesKeepsOrder)
+{
+    PageOrder order;
+    std::vector<SensorSet::key_type> sensors = {key("in", "2"),
+                                                key("curr", "1")};
+    order.sort(sensors);
+
+    EXPECT_THAT(sensors, ElementsAre(key("in", "2"), key("curr", "1")));
+}
+
+/** @brief Count the page switches per cycle on a 4 rail PMBus device.
+ *
+ *  The sensors are the ones the pmbus driver creates for a typical
+ *  multi-rail regulator, each output rail on its own page, read in the
+ *  order the main loop iterates them.
+ */
+TEST(PageOrderTest, PageSwitchesPerCycle)
+{
+    static constexpr auto rails = 4;
+
+    PageOrder order;
+    std::vector<SensorSet::key_type> sensors;
+    for (const auto& type : {"curr", "in", "power", "temp"})
+    {
+        // Input sensors, not paged.
+        sensors.push_back(key(type, "1"));
+        for (auto rail = 0; rail < rails; ++rail)
+        {
+            auto id = std::to_string(rail + 2);
+            sensors.push_back(key(type, id));
+            order.set(key(type, id), rail);
+        }
+    }
+
+    // std::map iteration order, as the main loop reads them by default.
+    std::sort(sensors.begin(), sensors.end());
+    auto before = order.switches(sensors);
+
+    order.sort(sensors);
+    auto after = order.switches(sensors);
+
+    EXPECT_EQ(static_cast<size_t>(rails - 1), after);
+    EXPECT_LT(after, before);
+}
+
+} // namespace
+} // namespace hwmon
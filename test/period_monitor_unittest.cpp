@@ -0,0 +1,67 @@
+#include "period_monitor.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+using Clock = PeriodMonitor::Clock;
+
+TEST(PeriodMonitorTest, SteadyTicksHaveNoJitter)
+{
+    PeriodMonitor period(1s);
+    Clock::time_point now{100s};
+
+    for (auto i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(0u, period.tick(now));
+        now += 1s;
+    }
+    EXPECT_EQ(Clock::duration{0}, period.jitter());
+}
+
+TEST(PeriodMonitorTest, CountsMissedTicks)
+{
+    PeriodMonitor period(1s);
+    Clock::time_point now{100s};
+
+    period.tick(now);
+    EXPECT_EQ(2u, period.tick(now + 3s));
+    EXPECT_EQ(0u, period.tick(now + 4s));
+}
+
+TEST(PeriodMonitorTest, JitterFollowsTheError)
+{
+    PeriodMonitor period(1s);
+    Clock::time_point now{100s};
+
+    period.tick(now);
+    // Early or late the same, and a late tick after missed ones only
+    // counts its error past the last deadline.
+    period.tick(now += 1016ms);
+    EXPECT_EQ(1ms, period.jitter());
+    period.tick(now += 984ms);
+    EXPECT_EQ(1937500ns, period.jitter());
+    period.tick(now += 3s);
+    EXPECT_EQ(1816406ns, period.jitter());
+}
+
+TEST(PeriodMonitorTest, FixedDelayMeasuresFromTheWait)
+{
+    PeriodMonitor period(1s);
+    Clock::time_point now{100s};
+
+    period.tick(now);
+    // A cycle taking 2.5s, then the fixed delay.
+    period.wait(now + 2500ms);
+    EXPECT_EQ(0u, period.tick(now + 3500ms));
+    EXPECT_EQ(Clock::duration{0}, period.jitter());
+}
+
+} // namespace
+} // namespace hwmon
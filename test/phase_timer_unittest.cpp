@@ -0,0 +1,47 @@
+#include "phase_timer.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+
+TEST(NextDeadlineTest, AlignsToInterval)
+{
+    EXPECT_EQ(2000000us, nextDeadline(1500000us, 0us, 1s));
+    EXPECT_EQ(2250000us, nextDeadline(1500000us, 250ms, 1s));
+}
+
+TEST(NextDeadlineTest, StrictlyAfterNow)
+{
+    EXPECT_EQ(3000000us, nextDeadline(2000000us, 0us, 1s));
+}
+
+TEST(NextDeadlineTest, SkipsMissedDeadlines)
+{
+    // A base long gone still gives the next deadline, not the ones missed.
+    EXPECT_EQ(10500000us, nextDeadline(10200000us, 500ms, 1s));
+}
+
+TEST(NextDeadlineTest, BaseInTheFuture)
+{
+    EXPECT_EQ(1000000us, nextDeadline(500000us, 3s, 1s));
+    EXPECT_EQ(1100000us, nextDeadline(1000000us, 2100ms, 1s));
+}
+
+TEST(NextDeadlineTest, InstancesStagger)
+{
+    // Instances started at different times but with the same interval
+    // and offsets 0 and 100ms keep 100ms apart.
+    auto a = nextDeadline(12345678us, 0us, 1s);
+    auto b = nextDeadline(12987654us, 100ms, 1s);
+    EXPECT_EQ(100ms, b - a);
+}
+
+} // namespace
+} // namespace hwmon
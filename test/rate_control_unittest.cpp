@@ -0,0 +1,69 @@
+#include "rate_control.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+
+TEST(RateControlTest, BacksOffOnErrorsDownToMin)
+{
+    RateControl rate(1s, 4s, 2);
+    EXPECT_EQ(1s, rate.interval());
+
+    EXPECT_TRUE(rate.cycle(1, 1ms));
+    EXPECT_EQ(2s, rate.interval());
+    EXPECT_TRUE(rate.cycle(3, 1ms));
+    EXPECT_EQ(4s, rate.interval());
+
+    // Can't go below the minimum rate.
+    EXPECT_FALSE(rate.cycle(1, 1ms));
+    EXPECT_EQ(4s, rate.interval());
+}
+
+TEST(RateControlTest, RecoversAdditively)
+{
+    RateControl rate(1s, 4s, 2);
+    rate.cycle(1, 1ms);
+    rate.cycle(1, 1ms);
+
+    // 0.25 polls per second, recovering by 0.1 each clean cycle.
+    EXPECT_TRUE(rate.cycle(0, 1ms));
+    EXPECT_EQ(std::chrono::duration_cast<RateControl::Clock::duration>(
+                  std::chrono::duration<double>(1 / 0.35)),
+              rate.interval());
+
+    for (auto i = 0; i < RateControl::recoveryCycles; ++i)
+    {
+        rate.cycle(0, 1ms);
+    }
+    EXPECT_EQ(1s, rate.interval());
+    EXPECT_FALSE(rate.cycle(0, 1ms));
+}
+
+TEST(RateControlTest, LatencySpikeBacksOff)
+{
+    RateControl rate(1s, 8s, 2);
+    for (auto i = 0; i < 5; ++i)
+    {
+        rate.cycle(0, 10ms);
+    }
+
+    EXPECT_FALSE(rate.cycle(0, 15ms));
+    EXPECT_EQ(1s, rate.interval());
+
+    EXPECT_TRUE(rate.cycle(0, 50ms));
+    EXPECT_EQ(2s, rate.interval());
+
+    // The spike isn't learnt as the usual latency.
+    EXPECT_TRUE(rate.cycle(0, 50ms));
+    EXPECT_EQ(4s, rate.interval());
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,194 @@
+#include "read_cycle.hpp"
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/base.hpp>
+#include <sdeventplus/source/event.hpp>
+
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+TEST(ReadCycleTest, NoBudgetRunsToCompletion)
+{
+    auto event = sdeventplus::Event::get_new();
+    size_t steps = 0;
+    size_t completed = 0;
+
+    ReadCycle cycle(event, [&]() { return ++steps < 5; },
+                    [&]() { ++completed; });
+
+    EXPECT_TRUE(cycle.start());
+    EXPECT_EQ(5u, steps);
+    EXPECT_EQ(1u, completed);
+    EXPECT_FALSE(cycle.running());
+}
+
+TEST(ReadCycleTest, YieldsWhenBudgetExhausted)
+{
+    auto event = sdeventplus::Event::get_new();
+    size_t steps = 0;
+    size_t completed = 0;
+
+    ReadCycle cycle(
+        event,
+        [&]() {
+            std::this_thread::sleep_for(1ms);
+            return ++steps < 5;
+        },
+        [&]() {
+            ++completed;
+            event.exit(0);
+        });
+    cycle.budget(1us);
+
+    EXPECT_TRUE(cycle.start());
+    EXPECT_EQ(1u, steps);
+    EXPECT_TRUE(cycle.running());
+
+    // A second start while in progress is refused.
+    EXPECT_FALSE(cycle.start());
+
+    event.loop();
+    EXPECT_EQ(5u, steps);
+    EXPECT_EQ(1u, completed);
+    EXPECT_FALSE(cycle.running());
+}
+
+TEST(ReadCycleTest, WaitingStepIsRunAgainLater)
+{
+    auto event = sdeventplus::Event::get_new();
+    size_t steps = 0;
+    size_t completed = 0;
+    bool waited = false;
+
+    std::optional<ReadCycle> cycle;
+    cycle.emplace(
+        event,
+        [&]() {
+            if (!waited)
+            {
+                // Not ready yet, don't count it as a step.
+                waited = true;
+                cycle->wait(5ms);
+                return true;
+            }
+            return ++steps < 3;
+        },
+        [&]() {
+            ++completed;
+            event.exit(0);
+        });
+
+    auto start = Clock::now();
+    EXPECT_TRUE(cycle->start());
+    EXPECT_EQ(0u, steps);
+    EXPECT_TRUE(cycle->running());
+
+    event.loop();
+    EXPECT_GE(Clock::now() - start, 5ms);
+    EXPECT_EQ(3u, steps);
+    EXPECT_EQ(1u, completed);
+}
+
+TEST(ReadCycleTest, PacedStepsAreSpreadAcrossSlots)
+{
+    auto event = sdeventplus::Event::get_new();
+    std::vector<Clock::time_point> steps;
+
+    ReadCycle cycle(
+        event,
+        [&]() {
+            steps.push_back(Clock::now());
+            return steps.size() < 6;
+        },
+        [&]() { event.exit(0); });
+    cycle.pace(5ms, 2);
+
+    auto start = Clock::now();
+    EXPECT_TRUE(cycle.start());
+    EXPECT_EQ(2u, steps.size());
+    EXPECT_TRUE(cycle.running());
+
+    event.loop();
+    ASSERT_EQ(6u, steps.size());
+    EXPECT_FALSE(cycle.running());
+
+    // Two steps per slot, the slots 5ms apart from the start.
+    EXPECT_LT(steps[1] - start, 5ms);
+    EXPECT_GE(steps[2] - start, 5ms);
+    EXPECT_GE(steps[4] - start, 10ms);
+}
+
+/** @brief Count the steps of a cycle run before a request issued part way
+ *         through it is dispatched.
+ *
+ *  The request is modelled as an important priority deferred source, the
+ *  same priority the D-Bus connection is attached to the event loop with.
+ */
+size_t stepsBeforeRequest(std::chrono::microseconds budget)
+{
+    static constexpr size_t sensors = 20;
+    static constexpr size_t requestAt = 3;
+
+    auto event = sdeventplus::Event::get_new();
+    size_t steps = 0;
+    bool completed = false;
+    std::optional<size_t> serviced;
+
+    sdeventplus::source::Defer request(event,
+                                       [&](auto&) { serviced = steps; });
+    request.set_priority(SD_EVENT_PRIORITY_IMPORTANT);
+    request.set_enabled(sdeventplus::source::Enabled::Off);
+
+    ReadCycle cycle(
+        event,
+        [&]() {
+            // Longer than the budget, so a sliced cycle yields after each
+            // step.
+            std::this_thread::sleep_for(budget + 10us);
+            if (++steps == requestAt)
+            {
+                request.set_enabled(sdeventplus::source::Enabled::OneShot);
+            }
+            return steps < sensors;
+        },
+        [&]() { completed = true; });
+    cycle.budget(budget);
+
+    sdeventplus::source::Defer kick(event, [&](auto&) { cycle.start(); });
+    kick.set_enabled(sdeventplus::source::Enabled::OneShot);
+
+    for (size_t i = 0; i < 100 && !(completed && serviced); ++i)
+    {
+        event.run(1ms);
+    }
+
+    EXPECT_EQ(sensors, steps);
+    EXPECT_TRUE(completed);
+    return serviced.value_or(0);
+}
+
+TEST(ReadCycleTest, RequestWaitsForBlockingCycle)
+{
+    EXPECT_EQ(20u, stepsBeforeRequest(0us));
+}
+
+TEST(ReadCycleTest, RequestDispatchedBetweenSlices)
+{
+    EXPECT_EQ(3u, stepsBeforeRequest(1us));
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,109 @@
+#include "recovery.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+using State = Recovery::State;
+
+TEST(RecoveryTest, DegradesThenRecovers)
+{
+    Recovery recovery(1s, 8s, 3);
+    Recovery::Clock::time_point now{100s};
+
+    EXPECT_FALSE(degraded());
+    EXPECT_EQ(State::degraded, recovery.fail(now));
+    EXPECT_TRUE(degraded());
+
+    // Further failures before the attempt change nothing.
+    EXPECT_EQ(State::degraded, recovery.fail(now + 500ms));
+    EXPECT_FALSE(recovery.attempt(now + 500ms));
+
+    EXPECT_TRUE(recovery.attempt(now + 1s));
+    EXPECT_TRUE(recovery.finish());
+    EXPECT_EQ(State::healthy, recovery.state());
+    EXPECT_FALSE(degraded());
+}
+
+TEST(RecoveryTest, BacksOffBetweenAttempts)
+{
+    Recovery recovery(1s, 3s, 10);
+    Recovery::Clock::time_point now{100s};
+
+    recovery.fail(now);
+    for (auto backoff : {2s, 3s, 3s})
+    {
+        now += 10s;
+        ASSERT_TRUE(recovery.attempt(now));
+        EXPECT_EQ(State::degraded, recovery.fail(now));
+        EXPECT_FALSE(recovery.finish());
+        EXPECT_FALSE(recovery.attempt(now + backoff - 1ms));
+        EXPECT_TRUE(recovery.attempt(now + backoff));
+        recovery.fail(now + backoff);
+        now += backoff;
+    }
+    EXPECT_EQ(6u, recovery.attempts());
+}
+
+TEST(RecoveryTest, FailsOnceOutOfBudget)
+{
+    Recovery recovery(1s, 1s, 2);
+    Recovery::Clock::time_point now{100s};
+
+    recovery.fail(now);
+    ASSERT_TRUE(recovery.attempt(now += 1s));
+    EXPECT_EQ(State::degraded, recovery.fail(now));
+    ASSERT_TRUE(recovery.attempt(now += 1s));
+    EXPECT_EQ(State::failed, recovery.fail(now));
+    EXPECT_FALSE(recovery.attempt(now += 1s));
+}
+
+TEST(RecoveryTest, RecoveryIsTheDevices)
+{
+    EXPECT_EQ(nullptr, recovery());
+    {
+        Recovery r(1s, 1s, 1);
+        EXPECT_EQ(&r, recovery());
+    }
+    EXPECT_EQ(nullptr, recovery());
+}
+
+TEST(RecoveryTest, DegradeIsReportedOnce)
+{
+    Recovery recovery(1s, 1s, 3);
+    Recovery::Clock::time_point now{100s};
+    size_t degrades = 0;
+    recovery.onDegrade([&]() { ++degrades; });
+
+    recovery.fail(now);
+    recovery.fail(now + 500ms);
+    EXPECT_EQ(1u, degrades);
+
+    // Only a failed attempt of a degraded device, not a new degrade.
+    ASSERT_TRUE(recovery.attempt(now += 1s));
+    recovery.fail(now);
+    EXPECT_EQ(1u, degrades);
+
+    ASSERT_TRUE(recovery.attempt(now += 1s));
+    ASSERT_TRUE(recovery.finish());
+    recovery.fail(now);
+    EXPECT_EQ(2u, degrades);
+}
+
+TEST(RecoveryTest, DegradesOnlyWithRecovery)
+{
+    EXPECT_FALSE(degrade("/sys/devices/test"));
+
+    Recovery recovery(1s, 1s, 1);
+    EXPECT_TRUE(degrade("/sys/devices/test"));
+    EXPECT_TRUE(degraded());
+}
+
+} // namespace
+} // namespace hwmon
@@ -0,0 +1,199 @@
+#include "hwmonio.hpp"
+#include "hwmonio_mock.hpp"
+#include "rt.hpp"
+#include "sensor.hpp"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <new>
+#include <string>
+#include <system_error>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace
+{
+
+std::atomic<bool> counting = false;
+std::atomic<size_t> allocations = 0;
+
+} // namespace
+
+// Count every heap allocation made while counting is set.
+void* operator new(size_t size)
+{
+    if (counting)
+    {
+        ++allocations;
+    }
+
+    if (auto p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace rt
+{
+namespace
+{
+
+using ::testing::ElementsAre;
+using ::testing::Return;
+
+class AttributeTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char name[] = "/tmp/hwmon-rt-XXXXXX";
+        auto fd = mkstemp(name);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path = name;
+
+        std::ofstream(path) << "1000\n";
+    }
+
+    void TearDown() override
+    {
+        unlink(path.c_str());
+    }
+
+    std::string path;
+};
+
+TEST_F(AttributeTest, ReadsAndWrites)
+{
+    hwmonio::Attribute attr(path);
+
+    EXPECT_EQ(1000, attr.read(hwmonio::retries, hwmonio::delay));
+
+    attr.write(1234, hwmonio::retries, hwmonio::delay);
+    EXPECT_EQ(1234, attr.read(hwmonio::retries, hwmonio::delay));
+}
+
+TEST_F(AttributeTest, NotANumberIsStreamError)
+{
+    std::ofstream(path) << "garbage\n";
+    hwmonio::Attribute attr(path);
+
+    auto val = attr.tryRead(hwmonio::retries, hwmonio::delay);
+    ASSERT_FALSE(val);
+    EXPECT_EQ(std::make_error_code(std::io_errc::stream), val.error());
+    EXPECT_THROW(attr.read(hwmonio::retries, hwmonio::delay),
+                 std::system_error);
+}
+
+TEST_F(AttributeTest, OpenFailureThrows)
+{
+    EXPECT_THROW(hwmonio::Attribute("/nonexistent/fan1_input"),
+                 std::system_error);
+}
+
+TEST_F(AttributeTest, SteadyStateDoesNotAllocate)
+{
+    // Same shape as the fan hot path: a target write followed by a tach
+    // read, both through attributes opened up front.
+    hwmonio::Attribute target(path);
+    hwmonio::Attribute tach(path);
+
+    allocations = 0;
+    counting = true;
+    int64_t sum = 0;
+    for (uint64_t value = 1000; value < 2000; ++value)
+    {
+        target.write(value, hwmonio::retries, hwmonio::delay);
+        sum += tach.read(hwmonio::retries, hwmonio::delay);
+    }
+    counting = false;
+
+    EXPECT_EQ(0u, allocations);
+    EXPECT_EQ(1499500, sum);
+}
+
+TEST(SensorReadTest, SteadyStateDoesNotAllocate)
+{
+    // Same shape as MainLoop::readSensor in real-time mode: the fault
+    // then the value through the attributes kept open, then adjusted.
+    char tmpl[] = "/tmp/hwmon-rt-XXXXXX";
+    std::string dir = mkdtemp(tmpl);
+    std::ofstream(dir + "/temp1_input") << "1000\n";
+    std::ofstream(dir + "/temp1_fault") << "0\n";
+    setenv("RT_MODE", "true", 1);
+
+    hwmonio::HwmonIOMock io;
+    EXPECT_CALL(io, path()).WillRepeatedly(Return(dir));
+    std::string devPath = "/sys/devices/test";
+    sensor::Sensor sensor(std::make_pair("temp", "1"), &io, devPath);
+    sensor.openInput();
+    ASSERT_NE(nullptr, sensor.getInput());
+    ASSERT_NE(nullptr, sensor.getFault());
+
+    allocations = 0;
+    counting = true;
+    SensorValueType sum = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        if (sensor.getFault()->read(hwmonio::retries, hwmonio::delay) == 0)
+        {
+            auto result =
+                sensor.getInput()->tryRead(hwmonio::retries, hwmonio::delay);
+            sum += sensor.adjustValue(*result);
+        }
+    }
+    counting = false;
+
+    EXPECT_EQ(0u, allocations);
+    EXPECT_EQ(1000000, sum);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SensorReadTest, IioDeviceHasNoAttributesToOpen)
+{
+    setenv("RT_MODE", "true", 1);
+
+    hwmonio::HwmonIOMock io;
+    EXPECT_CALL(io, path())
+        .WillRepeatedly(Return("/sys/bus/iio/devices/iio:device0"));
+    std::string devPath = "/sys/devices/test";
+    sensor::Sensor sensor(std::make_pair("in", "0"), &io, devPath);
+    sensor.openInput();
+    EXPECT_EQ(nullptr, sensor.getInput());
+    EXPECT_EQ(nullptr, sensor.getFault());
+}
+
+TEST(CpuListTest, ParsesCpusAndRanges)
+{
+    EXPECT_THAT(*parseCpuList("1"), ElementsAre(1));
+    EXPECT_THAT(*parseCpuList("0,2-4"), ElementsAre(0, 2, 3, 4));
+}
+
+TEST(CpuListTest, RejectsInvalidLists)
+{
+    EXPECT_FALSE(parseCpuList("a"));
+    EXPECT_FALSE(parseCpuList("3-1"));
+    EXPECT_FALSE(parseCpuList("1-"));
+    EXPECT_FALSE(parseCpuList("1;2"));
+}
+
+} // namespace
+} // namespace rt
@@ -0,0 +1,105 @@
+#include "schedule.hpp"
+
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+
+class ScheduleTest : public ::testing::Test
+{
+  protected:
+    Schedule schedule;
+    SensorSet::key_type sensor = std::make_pair(std::string("temp"),
+                                                std::string("1"));
+    Schedule::Clock::time_point now = Schedule::Clock::now();
+};
+
+TEST_F(ScheduleTest, ReadEveryCycleByDefault)
+{
+    EXPECT_TRUE(schedule.due(sensor, now, 0s));
+    schedule.read(sensor, now);
+    EXPECT_TRUE(schedule.due(sensor, now, 0s));
+    EXPECT_EQ(0s, schedule.period(sensor));
+}
+
+TEST_F(ScheduleTest, SkippedUntilPeriodExpires)
+{
+    schedule.period(sensor, 5s);
+    EXPECT_TRUE(schedule.due(sensor, now, 0s));
+
+    schedule.read(sensor, now);
+    EXPECT_FALSE(schedule.due(sensor, now + 4s, 0s));
+    EXPECT_TRUE(schedule.due(sensor, now + 5s, 0s));
+}
+
+TEST_F(ScheduleTest, DueUntilRead)
+{
+    // A sensor left unread, such as one deferred by an overrun, is still
+    // due the next cycle.
+    schedule.period(sensor, 5s);
+    schedule.read(sensor, now);
+    EXPECT_TRUE(schedule.due(sensor, now + 5s, 0s));
+    EXPECT_TRUE(schedule.due(sensor, now + 6s, 0s));
+
+    // Unless its reads have been suspended meanwhile.
+    schedule.throttle(sensor, 0s);
+    EXPECT_FALSE(schedule.due(sensor, now + 6s, 0s));
+}
+
+TEST_F(ScheduleTest, SlackAllowsEarlyRead)
+{
+    schedule.period(sensor, 5s);
+    schedule.read(sensor, now);
+
+    EXPECT_FALSE(schedule.due(sensor, now + 4900ms, 0s));
+    EXPECT_TRUE(schedule.due(sensor, now + 4900ms, 500ms));
+}
+
+TEST_F(ScheduleTest, NewPeriodAppliesFromLastRead)
+{
+    schedule.period(sensor, 5s);
+    schedule.read(sensor, now);
+
+    schedule.period(sensor, 2s);
+    EXPECT_TRUE(schedule.due(sensor, now + 2s, 0s));
+
+    schedule.period(sensor, 0s);
+    EXPECT_TRUE(schedule.due(sensor, now, 0s));
+}
+
+TEST_F(ScheduleTest, SuspendedUntilThrottleLifted)
+{
+    schedule.read(sensor, now);
+    schedule.throttle(sensor, 0s);
+    EXPECT_TRUE(schedule.suspended(sensor));
+    EXPECT_FALSE(schedule.due(sensor, now + 1h, 0s));
+
+    // Lifting the throttle reads the sensor again straight away.
+    schedule.throttle(sensor, std::nullopt);
+    EXPECT_FALSE(schedule.suspended(sensor));
+    EXPECT_TRUE(schedule.due(sensor, now, 0s));
+}
+
+TEST_F(ScheduleTest, ThrottleOverridesPeriod)
+{
+    schedule.period(sensor, 1s);
+    schedule.throttle(sensor, 10s);
+    schedule.read(sensor, now);
+    EXPECT_FALSE(schedule.due(sensor, now + 5s, 0s));
+    EXPECT_TRUE(schedule.due(sensor, now + 10s, 0s));
+
+    schedule.throttle(sensor, std::nullopt);
+    schedule.read(sensor, now);
+    EXPECT_EQ(1s, schedule.period(sensor));
+    EXPECT_TRUE(schedule.due(sensor, now + 1s, 0s));
+}
+
+} // namespace
+} // namespace hwmon
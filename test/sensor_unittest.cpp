@@ -60,6 +60,8 @@ TEST_F(SensorTest, BasicConstructorTest)
     EXPECT_CALL(env::mockEnv, get(StrEq("OFFSET_temp5"))).WillOnce(Return(""));
     EXPECT_CALL(env::mockEnv, get(StrEq("REMOVERCS_temp5")))
         .WillOnce(Return(""));
+    EXPECT_CALL(env::mockEnv, get(StrEq("ASYNC_READ_TIMEOUT_temp5")))
+        .WillOnce(Return(""));
 
     auto sensor =
         std::make_unique<sensor::Sensor>(sensorKey, hwmonio_mock.get(), path);
@@ -97,6 +99,8 @@ TEST_F(SensorTest, SensorRequiresGpio)
     EXPECT_CALL(env::mockEnv, get(StrEq("OFFSET_temp5"))).WillOnce(Return(""));
     EXPECT_CALL(env::mockEnv, get(StrEq("REMOVERCS_temp5")))
         .WillOnce(Return(""));
+    EXPECT_CALL(env::mockEnv, get(StrEq("ASYNC_READ_TIMEOUT_temp5")))
+        .WillOnce(Return(""));
 
     auto sensor =
         std::make_unique<sensor::Sensor>(sensorKey, hwmonio_mock.get(), path);
@@ -124,6 +128,8 @@ TEST_F(SensorTest, SensorHasGainAndOffsetAdjustValue)
         .WillOnce(Return("15"));
     EXPECT_CALL(env::mockEnv, get(StrEq("REMOVERCS_temp5")))
         .WillOnce(Return(""));
+    EXPECT_CALL(env::mockEnv, get(StrEq("ASYNC_READ_TIMEOUT_temp5")))
+        .WillOnce(Return(""));
 
     auto sensor =
         std::make_unique<sensor::Sensor>(sensorKey, hwmonio_mock.get(), path);
@@ -133,3 +139,63 @@ TEST_F(SensorTest, SensorHasGainAndOffsetAdjustValue)
     double resultValue = sensor->adjustValue(startingValue);
     EXPECT_DOUBLE_EQ(resultValue, 25.0);
 }
+
+TEST_F(SensorTest, UnadjustValueReversesGainAndOffset)
+{
+    /* Thresholds are programmed as raw values, the reverse of adjustValue.
+     */
+
+    auto sensorKey = std::make_pair(temp, five);
+    std::unique_ptr<hwmonio::HwmonIOInterface> hwmonio_mock =
+        std::make_unique<hwmonio::HwmonIOMock>();
+    std::string path = "/";
+
+    EXPECT_CALL(env::mockEnv, get(StrEq("GPIOCHIP_temp5")))
+        .WillOnce(Return(""));
+    EXPECT_CALL(env::mockEnv, get(StrEq("GPIO_temp5"))).WillOnce(Return(""));
+
+    EXPECT_CALL(env::mockEnv, get(StrEq("GAIN_temp5"))).WillOnce(Return("10"));
+    EXPECT_CALL(env::mockEnv, get(StrEq("OFFSET_temp5")))
+        .WillOnce(Return("15"));
+    EXPECT_CALL(env::mockEnv, get(StrEq("REMOVERCS_temp5")))
+        .WillOnce(Return(""));
+    EXPECT_CALL(env::mockEnv, get(StrEq("ASYNC_READ_TIMEOUT_temp5")))
+        .WillOnce(Return(""));
+
+    auto sensor =
+        std::make_unique<sensor::Sensor>(sensorKey, hwmonio_mock.get(), path);
+
+    EXPECT_THAT(sensor->unadjustValue(25.0), Eq(1));
+    EXPECT_THAT(sensor->unadjustValue(sensor->adjustValue(42)), Eq(42));
+    // Rounded to the nearest raw value.
+    EXPECT_THAT(sensor->unadjustValue(29.0), Eq(1));
+    EXPECT_THAT(sensor->unadjustValue(21.0), Eq(1));
+    // Below the offset, left to the caller to reject.
+    EXPECT_THAT(sensor->unadjustValue(5.0), Eq(-1));
+}
+
+TEST_F(SensorTest, UnadjustValueWithoutGain)
+{
+    /* A zero gain can't be reversed. */
+
+    auto sensorKey = std::make_pair(temp, five);
+    std::unique_ptr<hwmonio::HwmonIOInterface> hwmonio_mock =
+        std::make_unique<hwmonio::HwmonIOMock>();
+    std::string path = "/";
+
+    EXPECT_CALL(env::mockEnv, get(StrEq("GPIOCHIP_temp5")))
+        .WillOnce(Return(""));
+    EXPECT_CALL(env::mockEnv, get(StrEq("GPIO_temp5"))).WillOnce(Return(""));
+
+    EXPECT_CALL(env::mockEnv, get(StrEq("GAIN_temp5"))).WillOnce(Return("0"));
+    EXPECT_CALL(env::mockEnv, get(StrEq("OFFSET_temp5"))).WillOnce(Return(""));
+    EXPECT_CALL(env::mockEnv, get(StrEq("REMOVERCS_temp5")))
+        .WillOnce(Return(""));
+    EXPECT_CALL(env::mockEnv, get(StrEq("ASYNC_READ_TIMEOUT_temp5")))
+        .WillOnce(Return(""));
+
+    auto sensor =
+        std::make_unique<sensor::Sensor>(sensorKey, hwmonio_mock.get(), path);
+
+    EXPECT_FALSE(sensor->unadjustValue(25.0));
+}
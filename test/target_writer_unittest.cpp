@@ -0,0 +1,140 @@
+#include "target_writer.hpp"
+
+#include <sdeventplus/event.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <system_error>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace hwmon
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+using ::testing::ElementsAre;
+
+class TargetWriterTest : public ::testing::Test
+{
+  protected:
+    /** @brief Run the event loop long enough for the window to close. */
+    void runFor(std::chrono::milliseconds duration)
+    {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end)
+        {
+            event.run(1ms);
+        }
+    }
+
+    std::unique_ptr<TargetWriter> makeWriter(std::chrono::milliseconds resync)
+    {
+        return std::make_unique<TargetWriter>(
+            event, 1ms, resync,
+            [this](uint64_t value) {
+                if (failNext)
+                {
+                    failNext = false;
+                    throw std::system_error(EIO, std::generic_category());
+                }
+                written.push_back(value);
+            },
+            [this](const std::system_error& e) {
+                failures.push_back(e.code().value());
+            });
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    std::vector<uint64_t> written;
+    std::vector<int> failures;
+    bool failNext = false;
+};
+
+TEST_F(TargetWriterTest, CoalescesToLastValue)
+{
+    auto writer = makeWriter(0ms);
+
+    writer->set(1);
+    writer->set(2);
+    writer->set(3);
+    EXPECT_TRUE(written.empty());
+
+    runFor(10ms);
+    EXPECT_THAT(written, ElementsAre(3));
+}
+
+TEST_F(TargetWriterTest, CancelDropsPendingValue)
+{
+    auto writer = makeWriter(0ms);
+
+    EXPECT_FALSE(writer->cancel());
+    writer->set(1);
+    EXPECT_TRUE(writer->cancel());
+
+    runFor(10ms);
+    EXPECT_TRUE(written.empty());
+
+    // Values set afterwards are written as usual.
+    writer->set(2);
+    runFor(10ms);
+    EXPECT_THAT(written, ElementsAre(2));
+}
+
+TEST_F(TargetWriterTest, SkipsUnchangedValue)
+{
+    auto writer = makeWriter(0ms);
+
+    writer->set(5);
+    runFor(10ms);
+    writer->set(5);
+    runFor(10ms);
+    writer->set(6);
+    runFor(10ms);
+
+    EXPECT_THAT(written, ElementsAre(5, 6));
+}
+
+TEST_F(TargetWriterTest, ResyncRewritesUnchangedValue)
+{
+    auto writer = makeWriter(2ms);
+
+    writer->set(5);
+    runFor(10ms);
+    writer->set(5);
+    runFor(10ms);
+
+    EXPECT_THAT(written, ElementsAre(5, 5));
+}
+
+TEST_F(TargetWriterTest, FailureIsReportedAndRetried)
+{
+    auto writer = makeWriter(0ms);
+
+    failNext = true;
+    writer->set(7);
+    runFor(10ms);
+    EXPECT_TRUE(written.empty());
+    EXPECT_THAT(failures, ElementsAre(EIO));
+
+    // The failed value isn't treated as written, so it isn't skipped.
+    writer->set(7);
+    runFor(10ms);
+    EXPECT_THAT(written, ElementsAre(7));
+
+    // Nor is the value written before the failure, the device may have
+    // lost it.
+    failNext = true;
+    writer->set(8);
+    runFor(10ms);
+    writer->set(7);
+    runFor(10ms);
+    EXPECT_THAT(written, ElementsAre(7, 7));
+    EXPECT_THAT(failures, ElementsAre(EIO, EIO));
+}
+
+} // namespace
+} // namespace hwmon
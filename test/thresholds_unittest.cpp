@@ -0,0 +1,132 @@
+#include "env_mock.hpp"
+#include "hwmonio_mock.hpp"
+#include "sensor.hpp"
+#include "thresholds.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace env
+{
+
+// Delegate all calls to getEnv() to the mock
+const char* EnvImpl::get(const char* key) const
+{
+    return mockEnv.get(key);
+}
+
+EnvImpl env_impl;
+
+} // namespace env
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::StrEq;
+
+class ProgramThresholdsTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/thresholds_unittest.XXXXXX";
+        dir = mkdtemp(tmpl);
+
+        EXPECT_CALL(env::mockEnv, get(_)).WillRepeatedly(Return(nullptr));
+        ON_CALL(io, path()).WillByDefault(Return(dir));
+    }
+
+    void TearDown() override
+    {
+        ::testing::Mock::VerifyAndClearExpectations(&env::mockEnv);
+        std::filesystem::remove_all(dir);
+    }
+
+    void touch(const std::string& name)
+    {
+        std::ofstream(dir + "/" + name) << "0\n";
+    }
+
+    void setEnv(const char* key, const char* value)
+    {
+        EXPECT_CALL(env::mockEnv, get(StrEq(key)))
+            .WillRepeatedly(Return(value));
+    }
+
+    NiceMock<sdbusplus::SdBusMock> sdbusMock;
+    sdbusplus::bus_t bus = sdbusplus::get_mocked_new(&sdbusMock);
+    NiceMock<hwmonio::HwmonIOMock> io;
+    std::string dir;
+    SensorSet::key_type key{"temp", "5"};
+    ObjectInfo info{&bus, "/xyz/openbmc_project/sensors/temperature/t5",
+                    InterfaceMap()};
+};
+
+TEST_F(ProgramThresholdsTest, WritesLimitsThatExist)
+{
+    setEnv("WARNLO_temp5", "10");
+    setEnv("WARNHI_temp5", "90");
+    touch("temp5_max");
+
+    sensor::Sensor sensor(key, &io, dir);
+    addThreshold<WarningObject>("temp", "5", 50, info, 0);
+
+    EXPECT_CALL(io, write(90, StrEq("temp"), StrEq("5"), StrEq("max"), _, _));
+    // There's no temp5_min.
+    EXPECT_CALL(io, write(_, _, _, StrEq("min"), _, _)).Times(0);
+
+    programThresholds<WarningObject>(key, "5", sensor, &io, info);
+}
+
+TEST_F(ProgramThresholdsTest, AlarmIsNotLimit)
+{
+    setEnv("CRITLO_temp5", "5");
+    setEnv("CRITHI_temp5", "100");
+    // Listed in the SensorSet as crit and lcrit.
+    touch("temp5_crit_alarm");
+    touch("temp5_lcrit_alarm");
+
+    sensor::Sensor sensor(key, &io, dir);
+    addThreshold<CriticalObject>("temp", "5", 50, info, 0);
+
+    EXPECT_CALL(io, write(_, _, _, _, _, _)).Times(0);
+
+    programThresholds<CriticalObject>(key, "5", sensor, &io, info);
+}
+
+TEST_F(ProgramThresholdsTest, WritesRawValue)
+{
+    setEnv("GAIN_temp5", "2");
+    setEnv("OFFSET_temp5", "10");
+    setEnv("WARNHI_temp5", "90");
+    touch("temp5_max");
+
+    sensor::Sensor sensor(key, &io, dir);
+    addThreshold<WarningObject>("temp", "5", 50, info, 0);
+
+    EXPECT_CALL(io, write(40, StrEq("temp"), StrEq("5"), StrEq("max"), _, _));
+
+    programThresholds<WarningObject>(key, "5", sensor, &io, info);
+}
+
+TEST_F(ProgramThresholdsTest, SkipsLimitTooLarge)
+{
+    // 5 kW in microwatts doesn't fit the 32 bit limit.
+    SensorSet::key_type power{"power", "1"};
+    setEnv("CRITHI_power1", "5000000000");
+    touch("power1_crit");
+
+    sensor::Sensor sensor(power, &io, dir);
+    addThreshold<CriticalObject>("power", "1", 50, info, 0);
+
+    EXPECT_CALL(io, write(_, _, _, _, _, _)).Times(0);
+
+    programThresholds<CriticalObject>(power, "1", sensor, &io, info);
+}
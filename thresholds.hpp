@@ -1,9 +1,20 @@
 #pragma once
 
+#include "adaptive.hpp"
 #include "env.hpp"
+#include "hwmonio.hpp"
 #include "interface.hpp"
+#include "sensor.hpp"
+#include "sensorset.hpp"
+#include "sysfs.hpp"
+
+#include <phosphor-logging/log.hpp>
 
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <system_error>
 
 /** @class Thresholds
  *  @brief Threshold type traits.
@@ -26,6 +37,8 @@ struct Thresholds<WarningObject>
     static constexpr InterfaceType type = InterfaceType::WARN;
     static constexpr const char* envLo = "WARNLO";
     static constexpr const char* envHi = "WARNHI";
+    static constexpr const char* limitLo = "min";
+    static constexpr const char* limitHi = "max";
     static SensorValueType (WarningObject::* const setLo)(SensorValueType);
     static SensorValueType (WarningObject::* const setHi)(SensorValueType);
     static SensorValueType (WarningObject::* const getLo)() const;
@@ -47,6 +60,8 @@ struct Thresholds<CriticalObject>
     static constexpr InterfaceType type = InterfaceType::CRIT;
     static constexpr const char* envLo = "CRITLO";
     static constexpr const char* envHi = "CRITHI";
+    static constexpr const char* limitLo = "lcrit";
+    static constexpr const char* limitHi = "crit";
     static SensorValueType (CriticalObject::* const setLo)(SensorValueType);
     static SensorValueType (CriticalObject::* const setHi)(SensorValueType);
     static SensorValueType (CriticalObject::* const getLo)() const;
@@ -74,7 +89,7 @@ struct Thresholds<CriticalObject>
 template <typename T>
 void checkThresholds(std::any& iface, SensorValueType value)
 {
-    auto realIface = std::any_cast<std::shared_ptr<T>>(iface);
+    auto& realIface = std::any_cast<std::shared_ptr<T>&>(iface);
     auto lo = (*realIface.*Thresholds<T>::getLo)();
     auto hi = (*realIface.*Thresholds<T>::getHi)();
     auto alarmLowState = (*realIface.*Thresholds<T>::getAlarmLow)();
@@ -105,6 +120,23 @@ void checkThresholds(std::any& iface, SensorValueType value)
     }
 }
 
+/** @brief addBounds
+ *
+ *  Collect the bounds of a threshold interface for adaptive polling.
+ *
+ *  @tparam T - The threshold type.
+ *
+ *  @param[in] iface - An sdbusplus server threshold instance.
+ *  @param[in,out] bounds - The bounds to add to.
+ */
+template <typename T>
+void addBounds(std::any& iface, hwmon::Bounds& bounds)
+{
+    auto& realIface = std::any_cast<std::shared_ptr<T>&>(iface);
+    bounds.lows.push_back((*realIface.*Thresholds<T>::getLo)());
+    bounds.highs.push_back((*realIface.*Thresholds<T>::getHi)());
+}
+
 /** @brief addThreshold
  *
  *  Look for a configured threshold value in the environment and
@@ -175,3 +207,86 @@ auto addThreshold(const std::string& sensorType, const std::string& sensorID,
 
     return iface;
 }
+
+/** @brief programThresholds
+ *
+ *  Write the configured threshold values to the matching hwmon limit
+ *  attributes (ex. temp1_max), so the hardware raises the alarms itself.
+ *  Limits the chip doesn't have or won't accept are left alone.
+ *
+ *  @tparam T - The threshold type.
+ *
+ *  @param[in] sensor - The sensor's sysfs identifiers.
+ *  @param[in] sensorID - sensor ID of the threshold config, like '5'
+ *  @param[in] sensorObj - The sensor, to convert thresholds to raw values.
+ *  @param[in] ioAccess - Hwmon sysfs access.
+ *  @param[in] info - The sdbusplus server connection and interfaces.
+ */
+template <typename T>
+void programThresholds(const SensorSet::key_type& sensor,
+                       const std::string& sensorID,
+                       const sensor::Sensor& sensorObj,
+                       const hwmonio::HwmonIOInterface* ioAccess,
+                       ObjectInfo& info)
+{
+    auto& obj = std::get<InterfaceMap>(info);
+    auto it = obj.find(Thresholds<T>::type);
+    if (it == obj.end())
+    {
+        return;
+    }
+    auto iface = std::any_cast<std::shared_ptr<T>>(it->second);
+
+    auto program = [&](const char* envName, const char* limit,
+                       SensorValueType value) {
+        if (env::getEnv(envName, sensor.first, sensorID).empty())
+        {
+            return;
+        }
+
+        // Not the SensorSet's attributes, temp1_crit_alarm is listed there
+        // as crit.
+        std::error_code ec;
+        if (!std::filesystem::exists(
+                sysfs::make_sysfs_path(ioAccess->path(), sensor.first,
+                                       sensor.second, limit),
+                ec))
+        {
+            return;
+        }
+
+        // Limits are written as unsigned 32 bit values, one that doesn't
+        // fit would be programmed wrong.
+        auto raw = sensorObj.unadjustValue(value);
+        if (!raw)
+        {
+            return;
+        }
+        if (*raw < 0 || *raw > std::numeric_limits<uint32_t>::max())
+        {
+            using namespace phosphor::logging;
+            log<level::ERR>("Threshold out of range for the hardware limit",
+                            entry("SENSOR=%s%s", sensor.first.c_str(),
+                                  sensor.second.c_str()),
+                            entry("LIMIT=%s", limit),
+                            entry("VALUE=%lld",
+                                  static_cast<long long>(*raw)));
+            return;
+        }
+
+        try
+        {
+            ioAccess->write(*raw, sensor.first, sensor.second, limit,
+                            hwmonio::retries, hwmonio::delay);
+        }
+        catch (const std::system_error&)
+        {
+            // Not all chips can program their limits.
+        }
+    };
+
+    program(Thresholds<T>::envLo, Thresholds<T>::limitLo,
+            (*iface.*Thresholds<T>::getLo)());
+    program(Thresholds<T>::envHi, Thresholds<T>::limitHi,
+            (*iface.*Thresholds<T>::getHi)());
+}